@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# Runs every method of dom on every series of a corpus (see 
+# "domgen -corpus") and collects the runSeries output into one 
+# table (times in microseconds per pass over the series). All
+# records are also appended to <corpus>/bench.csv. Any further
+# arguments are passed on to dom (e.g. -compress, to compare the
+# memory used by the arcs against the decoding overhead).
+#
+# usage: bench.sh [corpus directory] [samples] [dom options]
+#
+
+CORPUS=${1:-corpus}
+SAMPLES=${2:-3}
+[ $# -ge 2 ] && shift 2 || shift $#
+DOM=./dom
+
+METHODS=`$DOM 2>&1 | sed -n 's/^Methods: *//p'`
+OUT=$CORPUS/bench.out
+
+printf "%-12s %-6s %7s %10s %10s %12s %14s %14s\n" series method graphs vertices arcs arcbytes medianu p90u
+for series in $CORPUS/*.series; do
+	name=`basename $series .series`
+	for method in $METHODS; do
+		if $DOM $series $method -samples $SAMPLES -mintime 0 -csv $CORPUS/bench.csv "$@" > $OUT 2>/dev/null; then
+			awk -v s=$name -v m=$method '
+				{v[$1] = $2}
+				END {printf "%-12s %-6s %7d %10d %10d %12d %14.2f %14.2f\n", s, m, v["graphs"], v["totalv"], v["totala"], v["arcbytes"], v["samplemedianu"], v["samplep90u"]}
+			' $OUT
+		else
+			printf "%-12s %-6s %7s\n" $name $method failed
+		fi
+	done
+done
+rm -f $OUT
@@ -0,0 +1,126 @@
+/*************************************
+ *
+ * BenchStats (summary of samples)
+ *
+ *************************************/
+
+#include "bench_stats.h"
+#include <stdlib.h>
+#include <math.h>
+
+static int compareDoubles (const void *a, const void *b) {
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return (x<y) ? -1 : (x>y) ? 1 : 0;
+}
+
+BenchStats::BenchStats() {
+	capacity = 64;
+	count = 0;
+	sample = new double [capacity];
+	sorted = NULL;
+	mean = median = p90 = p99 = stddev = minimum = maximum = trimmed = 0.0;
+	outliers = 0;
+}
+
+BenchStats::~BenchStats() {
+	delete [] sample;
+	if (sorted) delete [] sorted;
+}
+
+void BenchStats::add (double s) {
+	if (count==capacity) {
+		double *bigger = new double [2*capacity];
+		for (int i=0; i<count; i++) bigger[i] = sample[i];
+		delete [] sample;
+		sample = bigger;
+		capacity *= 2;
+	}
+	sample[count++] = s;
+}
+
+double BenchStats::getTotal() const {
+	double t = 0.0;
+	for (int i=0; i<count; i++) t += sample[i];
+	return t;
+}
+
+/*--------------------------------------------------------
+ | p-th percentile (0<=p<=1) with linear interpolation
+ | between the closest ranks
+ *-------------------------------------------------------*/
+
+double BenchStats::percentile (double p) const {
+	if (count==0) return 0.0;
+	double rank = p * (double)(count-1);
+	int lo = (int)floor(rank);
+	int hi = (lo+1<count) ? lo+1 : lo;
+	double f = rank - (double)lo;
+	return sorted[lo] + f * (sorted[hi] - sorted[lo]);
+}
+
+void BenchStats::summarize() {
+	if (sorted) delete [] sorted;
+	sorted = new double [count>0 ? count : 1];
+	for (int i=0; i<count; i++) sorted[i] = sample[i];
+	qsort (sorted, count, sizeof(double), compareDoubles);
+
+	mean = stddev = trimmed = 0.0;
+	outliers = 0;
+	if (count==0) {
+		median = p90 = p99 = minimum = maximum = 0.0;
+		return;
+	}
+
+	mean = getTotal() / (double)count;
+	for (int i=0; i<count; i++) stddev += (sample[i]-mean) * (sample[i]-mean);
+	stddev = (count>1) ? sqrt(stddev / (double)(count-1)) : 0.0;
+
+	minimum = sorted[0];
+	maximum = sorted[count-1];
+	median = percentile (0.50);
+	p90 = percentile (0.90);
+	p99 = percentile (0.99);
+
+	double q1 = percentile (0.25);
+	double q3 = percentile (0.75);
+	double lo = q1 - 1.5 * (q3-q1);
+	double hi = q3 + 1.5 * (q3-q1);
+	int kept = 0;
+	for (int i=0; i<count; i++) {
+		if (sample[i]<lo || sample[i]>hi) outliers++;
+		else {trimmed += sample[i]; kept++;}
+	}
+	trimmed = kept ? trimmed / (double)kept : mean;
+}
+
+void BenchStats::output (FILE *file, const char *prefix) const {
+	fprintf (file, "%scount %d\n", prefix, count);
+	fprintf (file, "%smeanu %.8f\n", prefix, 1000000.0 * mean);
+	fprintf (file, "%smedianu %.8f\n", prefix, 1000000.0 * median);
+	fprintf (file, "%sp90u %.8f\n", prefix, 1000000.0 * p90);
+	fprintf (file, "%sp99u %.8f\n", prefix, 1000000.0 * p99);
+	fprintf (file, "%sstddevu %.8f\n", prefix, 1000000.0 * stddev);
+	fprintf (file, "%sminu %.8f\n", prefix, 1000000.0 * minimum);
+	fprintf (file, "%smaxu %.8f\n", prefix, 1000000.0 * maximum);
+	fprintf (file, "%soutliers %d\n", prefix, outliers);
+	fprintf (file, "%strimmedu %.8f\n", prefix, 1000000.0 * trimmed);
+}
+
+void BenchStats::outputJSON (FILE *file) const {
+	fprintf (file, "\"samples\": %d, \"meanu\": %.6f, \"medianu\": %.6f, \"p90u\": %.6f, \"p99u\": %.6f, "
+	               "\"stddevu\": %.6f, \"minu\": %.6f, \"maxu\": %.6f, \"outliers\": %d, \"trimmedu\": %.6f, ",
+	         count, 1e6*mean, 1e6*median, 1e6*p90, 1e6*p99, 1e6*stddev, 1e6*minimum, 1e6*maximum, outliers, 1e6*trimmed);
+	fprintf (file, "\"sampleu\": [");
+	for (int i=0; i<count; i++) fprintf (file, "%s%.6f", i ? ", " : "", 1e6*sample[i]);
+	fprintf (file, "]");
+}
+
+void BenchStats::outputCSVHeader (FILE *file) {
+	fprintf (file, "samples,meanu,medianu,p90u,p99u,stddevu,minu,maxu,outliers,trimmedu");
+}
+
+void BenchStats::outputCSV (FILE *file) const {
+	fprintf (file, "%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%d,%.6f",
+	         count, 1e6*mean, 1e6*median, 1e6*p90, 1e6*p99, 1e6*stddev, 1e6*minimum, 1e6*maximum, outliers, 1e6*trimmed);
+}
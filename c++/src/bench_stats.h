@@ -0,0 +1,52 @@
+/**********************************************************
+ *
+ * BenchStats
+ * - collects timing samples (in seconds) and summarizes 
+ *   them: mean, median, p90, p99, standard deviation, 
+ *   extremes, and outliers (Tukey fences: outside 
+ *   [q1 - 1.5 iqr, q3 + 1.5 iqr]) with a mean that 
+ *   ignores them
+ * - outputs the summary as "key value" lines, as a JSON
+ *   object, or as a CSV row
+ *
+ **********************************************************/
+
+#ifndef bench_stats_h
+#define bench_stats_h
+
+#include <stdio.h>
+
+class BenchStats {
+	private:
+		double *sample;  //samples, in the order they were taken
+		double *sorted;  //sorted copy (valid after summarize)
+		int count, capacity;
+
+		//summary
+		double mean, median, p90, p99, stddev, minimum, maximum, trimmed;
+		int outliers;
+
+		double percentile (double p) const; //from the sorted copy
+
+	public:
+		BenchStats();
+		~BenchStats();
+
+		void add (double s);
+		void clear() {count = 0;}
+		int getCount() const {return count;}
+		double getTotal() const;
+
+		void summarize(); //must be called before the functions below
+		double getMedian() const {return median;}
+
+		//"<prefix><stat>u value" lines (times in microseconds)
+		void output (FILE *file, const char *prefix) const;
+
+		//JSON fields (no braces) and CSV columns, times in microseconds
+		void outputJSON (FILE *file) const;
+		static void outputCSVHeader (FILE *file);
+		void outputCSV (FILE *file) const;
+};
+
+#endif
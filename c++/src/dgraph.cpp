@@ -1,4 +1,6 @@
 #include "dgraph.h"
+#include "idom_writer.h"
+#include <string.h>
 
 void DominatorGraph::outputGraphStatistics (FILE *file) {
         int n = getNVertices();
@@ -14,6 +16,9 @@ void DominatorGraph::outputGraphStatistics (FILE *file) {
         fprintf (file, "originalsize %d\n", o+n);
         fprintf (file, "originalarcs %f\n", (double)o/(double)n);
         fprintf (file, "source %d\n", getSource());
+        fprintf (file, "weighted %d\n", (int)(weights!=NULL));
+        fprintf (file, "compressed %d\n", (int)compressed);
+        fprintf (file, "arcbytes %lld\n", getArcBytes());
         fprintf (file, "logvertices %d\n", log2(n));
         fprintf (file, "logarcs %d\n", log2(m));
         fprintf (file, "logsize %d\n", log2(m+n));
@@ -21,39 +26,57 @@ void DominatorGraph::outputGraphStatistics (FILE *file) {
 
 
 void DominatorGraph::output (FILE *file, bool reverse) {
+        OutputBuffer out (file);
         for (int v=1; v<=n; v++) {
-                fprintf (file, "%d:", v);
-                int *p, *stop;
-                if (!reverse) getOutBounds (v, p, stop);
-                else getInBounds (v, p, stop);
-                for (; p<stop; p++) {
-                        fprintf (file, " %d", *p);
+                out.putInt (v);
+                out.putChar (':');
+                int nbr;
+                AnyArcIterator a = reverse ? getInArcs (v) : getOutArcs (v);
+                while (a.next(nbr)) {
+                        out.putChar (' ');
+                        out.putInt (nbr);
                 }
-                fprintf (stderr, "\n");
+                out.putChar ('\n');
         }
 }
 
+/*----------------------------------------------------------
+ | number of back arcs in a dfs from r (zero iff the part of
+ | the graph reachable from r is acyclic); computed once
+ *---------------------------------------------------------*/
+
+int DominatorGraph::getBackArcs (int r) {
+        if (nback<0 || backroot!=r) {
+                int bsize = n+1;
+                int *buffer = mpNew<int> (2*bsize);
+                postDFSb (r, &buffer[0], &buffer[bsize], nback);
+                backroot = r;
+                mpDelete (buffer);
+        }
+        return nback;
+}
+
 int DominatorGraph::run_dfs (int r) {
         int bsize = n+1;
-        int *buffer = new int [3*bsize];
+        int *buffer = mpNew<int> (3*bsize);
         int *pre2label = &buffer[0];
         int *label2pre = &buffer[bsize];
         int *parent = &buffer[2*bsize];
         int visited  = preDFSp (r, label2pre, pre2label, parent); //, temp);
-        delete [] buffer;
+        mpDelete (buffer);
         return visited;
 }
 
 int DominatorGraph::run_bfs (int r) {
         int bsize = n+1;
-        int *buffer = new int[3*bsize];
+        int *buffer = mpNew<int> (3*bsize);
         int *pre2label = &buffer[0];
         int *label2pre = &buffer[bsize];
         int *parent    = &buffer[2*bsize];
 
         int visited  = preBFSp (r, label2pre, pre2label, parent);
 
-        delete [] buffer;
+        mpDelete (buffer);
         return visited;
 }
 
@@ -63,22 +86,48 @@ int DominatorGraph::run_bfs (int r) {
  | build the graph from a list of arcs
  *------------------------------------*/
 
-void DominatorGraph::buildGraph (int _nvertices, int _narcs, int _source, int *arclist, bool remove_duplicates) {
+/*-----------------------------------------------------------------
+ | If _storage is not NULL, the arrays are carved out of it (it must
+ | have getStorageSize() bytes); the graph frees it on destruction
+ | only if _own is true.
+ *----------------------------------------------------------------*/
+
+static inline size_t align64 (size_t bytes) {return (bytes + 63) & ~(size_t)63;}
+
+size_t DominatorGraph::getStorageSize (int _nvertices, int _narcs) {
+        return 2 * align64 ((_nvertices+2) * sizeof(intptr)) + 2 * align64 (_narcs * sizeof(int));
+}
+
+void DominatorGraph::buildGraph (int _nvertices, int _narcs, int _source, int *arclist, bool remove_duplicates, char *_storage, bool _own, const long long *_weights) {
         const bool verbose = false;
         int v;
 
         if (verbose) fprintf (stderr, "Building graph...\n");
         deleteAll(); //just in case
+        in_bytes = out_bytes = NULL;
+        compressed = false;
+        storage = _storage;
+        ownstorage = _own;
+        nback = -1;  //features of the old graph no longer valid
 
         n = _nvertices;
         narcs = _narcs;
         source = _source;
+        setWeights (_weights);
 
         //initialize arrays
-        first_in = new intptr [n+2];
-        first_out = new intptr [n+2];
-        in_arcs = new int [narcs];
-        out_arcs = new int [narcs];
+        if (storage) {
+                char *s = storage;
+                first_in = (intptr *)s;  s += align64 ((n+2) * sizeof(intptr));
+                first_out = (intptr *)s; s += align64 ((n+2) * sizeof(intptr));
+                in_arcs = (int *)s;      s += align64 (narcs * sizeof(int));
+                out_arcs = (int *)s;
+        } else {
+                first_in = mpNew<intptr> (n+2);
+                first_out = mpNew<intptr> (n+2);
+                in_arcs = mpNew<int> (narcs);
+                out_arcs = mpNew<int> (narcs);
+        }
 
         //temporarily, first_in and first_out will represent the degrees
         for (v=n+1; v>=0; v--) {
@@ -130,6 +179,160 @@ void DominatorGraph::buildGraph (int _nvertices, int _narcs, int _source, int *a
 }
 
 
+/*------------------------------------------------------------
+ | per-vertex weights (e.g., shallow object sizes); a copy of 
+ | w[1..n] is kept; NULL means every vertex weighs 1
+ *-----------------------------------------------------------*/
+
+void DominatorGraph::setWeights (const long long *w) {
+        if (weights) mpDelete (weights);
+        weights = NULL;
+        if (!w) return;
+        weights = mpNew<long long> (n+1);
+        weights[0] = 0;
+        for (int v=1; v<=n; v++) weights[v] = w[v];
+}
+
+
+/*-------------------------------------------------------------------
+ | Flat CSR image of the graph (used by the series cache): n+2 offsets
+ | into in_arcs, n+2 offsets into out_arcs, in_arcs, out_arcs (all 
+ | ints). loadCSR rebuilds the graph from such an image without any 
+ | parsing; the image itself may be read-only (e.g., mapped).
+ *------------------------------------------------------------------*/
+
+size_t DominatorGraph::getCSRSize (int _nvertices, int _narcs) {
+        return (2 * ((size_t)_nvertices+2) + 2 * (size_t)_narcs) * sizeof(int);
+}
+
+bool DominatorGraph::writeCSR (FILE *file) const {
+        assert (!compressed);
+        int *offsets = new int [n+2];
+        bool ok = true;
+        offsets[0] = 0;
+        for (int v=1; v<=n+1; v++) offsets[v] = (int)(first_in[v].ptr - in_arcs);
+        ok = ok && fwrite (offsets, sizeof(int), n+2, file)==(size_t)(n+2);
+        for (int v=1; v<=n+1; v++) offsets[v] = (int)(first_out[v].ptr - out_arcs);
+        ok = ok && fwrite (offsets, sizeof(int), n+2, file)==(size_t)(n+2);
+        ok = ok && fwrite (in_arcs, sizeof(int), narcs, file)==(size_t)narcs;
+        ok = ok && fwrite (out_arcs, sizeof(int), narcs, file)==(size_t)narcs;
+        delete [] offsets;
+        return ok;
+}
+
+void DominatorGraph::loadCSR (int _nvertices, int _narcs, int _onarcs, int _source, const int *csr, char *_storage, bool _own) {
+        deleteAll(); //just in case
+        in_bytes = out_bytes = NULL;
+        compressed = false;
+        storage = _storage;
+        ownstorage = _own;
+        nback = -1;
+
+        n = _nvertices;
+        narcs = _narcs;
+        onarcs = _onarcs;
+        source = _source;
+
+        if (storage) {
+                char *s = storage;
+                first_in = (intptr *)s;  s += align64 ((n+2) * sizeof(intptr));
+                first_out = (intptr *)s; s += align64 ((n+2) * sizeof(intptr));
+                in_arcs = (int *)s;      s += align64 (narcs * sizeof(int));
+                out_arcs = (int *)s;
+        } else {
+                first_in = mpNew<intptr> (n+2);
+                first_out = mpNew<intptr> (n+2);
+                in_arcs = mpNew<int> (narcs);
+                out_arcs = mpNew<int> (narcs);
+        }
+
+        const int *inoff = csr;
+        const int *outoff = inoff + (n+2);
+        memcpy (in_arcs, outoff + (n+2), narcs * sizeof(int));
+        memcpy (out_arcs, outoff + (n+2) + narcs, narcs * sizeof(int));
+        first_in[0].value = first_out[0].value = 0;
+        for (int v=1; v<=n+1; v++) {
+                first_in[v].ptr = &in_arcs[inoff[v]];
+                first_out[v].ptr = &out_arcs[outoff[v]];
+        }
+}
+
+
+/*--------------------------------------------------------------
+ | Compressed representation: each adjacency list is sorted and
+ | stored as the gaps between consecutive neighbors (the first 
+ | one relative to zero), as varints: 7 bits per byte, least
+ | significant first, high bit set on all but the last byte.
+ | first[v].bptr then points to the first byte of v's list.
+ *-------------------------------------------------------------*/
+
+static int compareInts (const void *a, const void *b) {
+        int x = *(const int *)a;
+        int y = *(const int *)b;
+        return (x<y) ? -1 : (x>y) ? 1 : 0;
+}
+
+static inline int varintSize (unsigned int x) {
+        int size = 1;
+        while (x >= 0x80) {x >>= 7; size++;}
+        return size;
+}
+
+unsigned char *DominatorGraph::encodeArcs (intptr *first, int *arcs) {
+        int v;
+        long long bytes = 0;
+        for (v=1; v<=n; v++) {
+                int *start = first[v].ptr;
+                int *stop = first[v+1].ptr;
+                qsort (start, stop-start, sizeof(int), compareInts);
+                int last = 0;
+                for (int *p=start; p<stop; p++) {
+                        bytes += varintSize (*p - last);
+                        last = *p;
+                }
+        }
+
+        unsigned char *code = mpNew<unsigned char> (bytes+1);
+        unsigned char *b = code;
+        first[0].bptr = code;
+        for (v=1; v<=n; v++) {
+                int *start = first[v].ptr;
+                int *stop = first[v+1].ptr; //still a pointer to arcs
+                first[v].bptr = b;
+                int last = 0;
+                for (int *p=start; p<stop; p++) {
+                        unsigned int x = *p - last;
+                        while (x >= 0x80) {
+                                *(b++) = (unsigned char)((x & 0x7f) | 0x80);
+                                x >>= 7;
+                        }
+                        *(b++) = (unsigned char)x;
+                        last = *p;
+                }
+        }
+        first[n+1].bptr = b;
+        return code;
+}
+
+void DominatorGraph::compressArcs () {
+        if (compressed || !in_arcs) return;
+        in_bytes = encodeArcs (first_in, in_arcs);
+        out_bytes = encodeArcs (first_out, out_arcs);
+        if (!storage) { //arrays in shared storage stay until it is freed
+                mpDelete (in_arcs);
+                mpDelete (out_arcs);
+        }
+        in_arcs = out_arcs = NULL;
+        compressed = true;
+        nback = -1; //the dfs order may have changed
+}
+
+long long DominatorGraph::getArcBytes () const {
+        if (!compressed) return 2 * (long long)narcs * (long long)sizeof(int);
+        return (first_in[n+1].bptr - first_in[0].bptr) + (first_out[n+1].bptr - first_out[0].bptr);
+}
+
+
 /*----------------------------------------
  | Eliminate duplicate arcs:
  | - Changes both 'first' and 'arcs'.
@@ -168,73 +371,188 @@ void DominatorGraph::eliminateDuplicates(intptr *first, int *arcs) {
 
 
 
-/*-------------------------------
- | read a graph in dimacs format
- *------------------------------*/
+/*-----------------------------------------------------------
+ | read a graph in dimacs format; errors are returned rather
+ | than reported, so that library callers survive bad input
+ *----------------------------------------------------------*/
 
-void DominatorGraph::readDimacs (const char *filename, bool reverse, bool simplify) {
+const char *DominatorGraph::readDimacs (const char *filename, bool reverse, bool simplify) {
         const bool verbose = false;
         if (verbose) fprintf (stderr, "Reading file \"%s\"... \n", filename);
 
         FILE *input = fopen (filename, "r");
-        if (!input) {
-                fprintf (stderr, "Error opening file \"%s\".\n", filename);
-                exit(-1);
-        }
+        if (!input) return "cannot open the file";
 
         int n, m, src, snk;
 
         if (fscanf(input,"p %d %d %d %d\n", &n, &m, &src, &snk)!=4) {
-                fprintf (stderr, "Error reading graph size (%s).\n", filename);
-                exit (-1);
+                fclose (input);
+                return "cannot read the graph size";
+        }
+        if (n<1 || m<0 || src<0 || src>n || snk<0 || snk>n) {
+                fclose (input);
+                return "bad graph size, source or sink";
         }
         if (verbose) fprintf (stderr, "File has %d nodes and %d edges, source is %d, sink is %d... ", n, m, src, snk);
         if (reverse) src = snk;
+        if (src==0) { //0 means "none"; only the vertex we start from must exist
+                fclose (input);
+                return reverse ? "graph has no sink" : "graph has no source";
+        }
 
-        int *arclist = new int [2*m];
+        int *arclist = mpNew<int> (2*m);
+        long long *vweights = NULL; //allocated on the first 'n' line
+        const char *error = NULL;
         int p = 0;
-        if (reverse) {
-                while (1) {
-                        int a, b;
-                        if (fscanf (input, "a %d %d\n", &a, &b)!=2) break; //arc from a to b
-                        arclist[p++] = b; //in reverse!
-                        arclist[p++] = a;
+        while (1) {
+                int a, b;
+                if (p<2*m && fscanf (input, "a %d %d\n", &a, &b)==2) { //arc from a to b
+                        if (a<1 || a>n || b<1 || b>n) {
+                                error = "arc with an invalid vertex";
+                                break;
+                        }
+                        if (reverse) {
+                                arclist[p++] = b; //in reverse!
+                                arclist[p++] = a;
+                        } else {
+                                arclist[p++] = a;
+                                arclist[p++] = b;
+                        }
+                        continue;
                 }
-        } else {
-                while (1) {
-                        int a, b;
-                        if (fscanf (input, "a %d %d\n", &a, &b)!=2) break; //arc from a to b
-                        arclist[p++] = a;
-                        arclist[p++] = b;
+
+                //"n v w": vertex v has weight w (vertices without a line weigh 0)
+                long long w;
+                if (fscanf (input, "n %d %lld\n", &a, &w)!=2) break;
+                if (a<1 || a>n) {
+                        error = "weight of an invalid vertex";
+                        break;
                 }
+                if (!vweights) {
+                        vweights = mpNew<long long> (n+1);
+                        for (int v=0; v<=n; v++) vweights[v] = 0;
+                }
+                vweights[a] = w;
         }
         fclose (input);
         if (verbose) fprintf (stderr, "done.\n");
-        buildGraph (n, m, src, arclist, simplify);
+        if (!error) buildGraph (n, p/2, src, arclist, simplify, NULL, false, vweights);
 
-        delete [] arclist;
+        mpDelete (arclist);
+        if (vweights) mpDelete (vweights);
+        return error;
 }
 
 
+/*-------------------------------------------------------------
+ | searches read from files instead (READ_DFS_FILES, debugging):
+ | parents and preorder (as preDFSp), or postorder (as postDFS)
+ *------------------------------------------------------------*/
+
+#ifdef READ_DFS_FILES
+int readDFS(const char* parents_filename,
+            const char* preorder_filename,
+            int* parent,
+            int* pre2label,
+            int* label2pre) {
+  FILE *input = fopen (parents_filename, "r");
+  if (!input) {
+    fprintf (stderr, "Error opening file \"%s\".\n", parents_filename);
+    exit(-1);
+  }
+
+  int n, src;
+  if (fscanf(input,"parents %d %d\n", &n, &src) != 2) {
+    fprintf (stderr, "Error reading graph size (%s).\n", parents_filename);
+    exit (-1);
+  }
+  parent[src] = 0;
+
+  while (1) {
+    int node, p;
+    if (fscanf(input, "%d %d\n", &node, &p)!=2)
+      break; //arc from a to b
+    parent[node] = p;
+  }
+  fclose (input);
+
+  input = fopen (preorder_filename, "r");
+  if (!input) {
+    fprintf (stderr, "Error opening file \"%s\".\n", preorder_filename);
+    exit(-1);
+  }
+
+  int n2;
+  if (fscanf(input,"preorder %d %d\n", &n2, &src) != 2) {
+    fprintf (stderr, "Error reading graph size (%s).\n", preorder_filename);
+    exit (-1);
+  }
+  if (n != n2) {
+    fprintf (stderr, "#nodes differ.\n");
+    exit (-1);
+  }
+
+  while (1) {
+    int pre, ord;
+    if (fscanf(input, "%d %d\n", &pre, &ord)!=2)
+      break; //arc from a to b
+    pre2label[pre] = ord;
+    label2pre[ord] = pre;
+  }
+  fclose (input);
+
+  return n;
+}
+
+int readPostDFS(const char* postorder_filename,
+                       int* post2label,
+                       int* label2post) {
+  int src;
+  FILE* input = fopen (postorder_filename, "r");
+  if (!input) {
+    fprintf (stderr, "Error opening file \"%s\".\n", postorder_filename);
+    exit(-1);
+  }
+
+  int n;
+  if (fscanf(input,"postorder %d %d\n", &n, &src) != 2) {
+    fprintf (stderr, "Error reading graph size (%s).\n", postorder_filename);
+    exit (-1);
+  }
+
+  while (1) {
+    int post, ord;
+    if (fscanf(input, "%d %d\n", &post, &ord)!=2)
+      break; //arc from a to b
+    post2label[post] = ord;
+    label2post[ord] = post;
+  }
+  fclose (input);
+
+  return n;
+}
+#endif
+
+
 /*------------------------
  | pre-dfs (with parents)
  *-----------------------*/
 
-void DominatorGraph::rpreDFSp (int v, PreDFSParams &params) {
-        int *p, *stop, pre_v;
+template <class Iterator> void DominatorGraph::rpreDFSp (int v, PreDFSParams &params) {
+        int pre_v, nbr;
         pre_v = params.next;
         params.pre2label[params.next] = v;   //v will have the next label
         params.label2pre[v] = params.next++; //v's label is next (and next is incremented)
-        getOutBounds(v,p,stop);
-        for (; p<stop; p++) { //visit all outgoing neighbors
-                if (!params.label2pre[*p]) {
+        Iterator a = outArcs<Iterator> (v);
+        while (a.next(nbr)) { //visit all outgoing neighbors
+                if (!params.label2pre[nbr]) {
                         params.parent[params.next] = pre_v;
-                        rpreDFSp(*p,params);
+                        rpreDFSp<Iterator> (nbr, params);
                 }
         }
 }
 
-int DominatorGraph::preDFSp (int v, int *label2pre, int *pre2label, int *parent) {//, int &next) {
+template <class Iterator> int DominatorGraph::preDFSp (int v, int *label2pre, int *pre2label, int *parent) {//, int &next) {
         PreDFSParams params;
         params.label2pre = label2pre;
         params.pre2label = pre2label;
@@ -242,7 +560,7 @@ int DominatorGraph::preDFSp (int v, int *label2pre, int *pre2label, int *parent)
         params.next = 1;
 
         for (int w=n; w>=0; w--) params.label2pre[w] = 0; //everybody unvisited
-        rpreDFSp (v, params); //visit everybody reachable from the root
+        rpreDFSp<Iterator> (v, params); //visit everybody reachable from the root
         return params.next - 1;
 }
 
@@ -285,26 +603,26 @@ int DominatorGraph::preDFSp (int v, int *label2pre, SLTData *data) {
  | post-dfs, does not store parents
  *---------------------------------*/
 
-void DominatorGraph::rpostDFS (int v, PostDFSParams &params) {
-        int *p, *stop;
+template <class Iterator> void DominatorGraph::rpostDFS (int v, PostDFSParams &params) {
+        int nbr;
         params.label2post[v] = -1;
 
-        getOutBounds (v, p, stop);
-        for (; p<stop; p++) {
-                if (!params.label2post[*p]) rpostDFS (*p, params);
+        Iterator a = outArcs<Iterator> (v);
+        while (a.next(nbr)) {
+                if (!params.label2post[nbr]) rpostDFS<Iterator> (nbr, params);
         }
         params.post2label[params.next] = v;
         params.label2post[v] = params.next++;
 }
 
-int DominatorGraph::postDFS (int v, int *label2post, int *post2label) {
+template <class Iterator> int DominatorGraph::postDFS (int v, int *label2post, int *post2label) {
         PostDFSParams params;
         params.label2post = label2post;
         params.post2label = post2label;
         params.next = 1;
 
         for (int w=n; w>=0; w--) params.label2post[w] = 0;
-        rpostDFS (v, params);
+        rpostDFS<Iterator> (v, params);
         return params.next-1;
 }
 
@@ -313,7 +631,7 @@ int DominatorGraph::postDFS (int v, int *label2post, int *post2label) {
  | NOTE: parent is indexed by pre_id numbers
  *-------------------------------------------*/
 
-int DominatorGraph::preBFSp (int r, int *label2pre, int *pre2label, int *parent) {
+template <class Iterator> int DominatorGraph::preBFSp (int r, int *label2pre, int *pre2label, int *parent) {
         int v, first, last;
 
         for (v=n; v>0; v--) label2pre[v] = 0; //everybody unreachable
@@ -323,13 +641,15 @@ int DominatorGraph::preBFSp (int r, int *label2pre, int *pre2label, int *parent)
         label2pre[r] = 1; //will be used to keep marks
         pre2label[1] = r; //will be used as a queue
         first = last = 1;
+        bfsarcs = 0;
 
         //process the other vertices
         while (first<=last) { //while queue not empty
-                int *p, *stop;
-                getOutBounds(pre2label[first], p, stop); //v = pre2label[first]
-                for (; p<stop; p++) { //scan first element in the queue
-                        int w = *p;
+                int nbr;
+                bfsarcs += getOutSize (pre2label[first]);
+                Iterator a = outArcs<Iterator> (pre2label[first]); //v = pre2label[first]
+                while (a.next(nbr)) { //scan first element in the queue
+                        int w = nbr;
                         if (!label2pre[w]) { //neighbor not yet processed
                                 pre2label[++last] = w; //insert w into the back of the queue
                                 label2pre[w] = last;   //note its position (pre-order)
@@ -347,21 +667,21 @@ int DominatorGraph::preBFSp (int r, int *label2pre, int *pre2label, int *parent)
  | WARNING: PARENT is a label->label function
  *---------------------------------------*/
 
-void DominatorGraph::rpostDFSp (int v, PostDFSParams &params) {
-        int *p, *stop;
+template <class Iterator> void DominatorGraph::rpostDFSp (int v, PostDFSParams &params) {
+        int nbr;
         params.label2post[v] = -1;     //mark node as visited
-        getOutBounds (v, p, stop);
-        for (; p<stop; p++) { //for each neighbor of v
-                if (!params.label2post[*p]) { //if neighbor not yet visited
-                        params.parent[*p] = v;  //mark v as its parent
-                        rpostDFSp (*p, params);     //and visit it
+        Iterator a = outArcs<Iterator> (v);
+        while (a.next(nbr)) { //for each neighbor of v
+                if (!params.label2post[nbr]) { //if neighbor not yet visited
+                        params.parent[nbr] = v;  //mark v as its parent
+                        rpostDFSp<Iterator> (nbr, params);     //and visit it
                 }
         }
         params.post2label[params.next] = v;   //v is the vertex with postid 'next'
         params.label2post[v] = params.next++; //postid of v is next; increment next
 }
 
-int DominatorGraph::postDFSp (int v, int *label2post, int *post2label, int *parent) { //int &next) {
+template <class Iterator> int DominatorGraph::postDFSp (int v, int *label2post, int *post2label, int *parent) { //int &next) {
         PostDFSParams params;
         params.label2post = label2post;
         params.post2label = post2label;
@@ -369,7 +689,141 @@ int DominatorGraph::postDFSp (int v, int *label2post, int *post2label, int *pare
         params.parent = parent;
 
         for (int w=n; w>=0; w--) params.label2post[w] = 0;
-        rpostDFSp (v, params);
+        rpostDFSp<Iterator> (v, params);
 
         return params.next - 1;
 }
+
+/*-------------------------------------------------------
+ | post-dfs, counts back arcs: an arc (v,w) is a back arc
+ | iff w is still on the stack (label2post[w]==-1) when
+ | the arc is scanned; the reachable subgraph is acyclic
+ | iff no back arc is found
+ *------------------------------------------------------*/
+
+template <class Iterator> void DominatorGraph::rpostDFSb (int v, PostDFSParams &params) {
+        int nbr;
+        params.label2post[v] = -1; //on the stack
+
+        Iterator a = outArcs<Iterator> (v);
+        while (a.next(nbr)) {
+                int l = params.label2post[nbr];
+                if (!l) rpostDFSb<Iterator> (nbr, params);
+                else if (l<0) params.back++;
+        }
+        params.post2label[params.next] = v;
+        params.label2post[v] = params.next++;
+}
+
+template <class Iterator> int DominatorGraph::postDFSb (int v, int *label2post, int *post2label, int &back) {
+        PostDFSParams params;
+        params.label2post = label2post;
+        params.post2label = post2label;
+        params.next = 1;
+        params.back = 0;
+
+        for (int w=n; w>=0; w--) params.label2post[w] = 0;
+        rpostDFSb<Iterator> (v, params);
+        back = params.back;
+        return params.next-1;
+}
+
+
+/*---------------------------------------------------------------
+ | searches for either arc iterator (the algorithms in the other
+ | files use them), and entry points that pick it
+ *--------------------------------------------------------------*/
+
+#define DFS_INSTANCES(Iterator) \
+        template int DominatorGraph::preDFSp<Iterator> (int, int *, int *, int *); \
+        template int DominatorGraph::postDFS<Iterator> (int, int *, int *); \
+        template int DominatorGraph::postDFSp<Iterator> (int, int *, int *, int *); \
+        template int DominatorGraph::postDFSb<Iterator> (int, int *, int *, int &); \
+        template int DominatorGraph::preBFSp<Iterator> (int, int *, int *, int *);
+
+DFS_INSTANCES(ArcIterator)
+DFS_INSTANCES(PackedArcIterator)
+
+int DominatorGraph::preDFSp (int v, int *label2pre, int *pre2label, int *parent) {
+        if (compressed) return preDFSp<PackedArcIterator> (v, label2pre, pre2label, parent);
+        return preDFSp<ArcIterator> (v, label2pre, pre2label, parent);
+}
+
+int DominatorGraph::postDFS (int v, int *label2post, int *post2label) {
+        if (compressed) return postDFS<PackedArcIterator> (v, label2post, post2label);
+        return postDFS<ArcIterator> (v, label2post, post2label);
+}
+
+int DominatorGraph::postDFSp (int v, int *label2post, int *post2label, int *parent) {
+        if (compressed) return postDFSp<PackedArcIterator> (v, label2post, post2label, parent);
+        return postDFSp<ArcIterator> (v, label2post, post2label, parent);
+}
+
+int DominatorGraph::postDFSb (int v, int *label2post, int *post2label, int &back) {
+        if (compressed) return postDFSb<PackedArcIterator> (v, label2post, post2label, back);
+        return postDFSb<ArcIterator> (v, label2post, post2label, back);
+}
+
+int DominatorGraph::preBFSp (int v, int *label2pre, int *pre2label, int *parent) {
+        if (compressed) return preBFSp<PackedArcIterator> (v, label2pre, pre2label, parent);
+        return preBFSp<ArcIterator> (v, label2pre, pre2label, parent);
+}
+
+
+/*----------------------------------------------------
+ | dominator methods by name (see dgraph.h); the names
+ | follow the order of Method
+ *---------------------------------------------------*/
+
+static const char *methodnames[DominatorGraph::DM_METHODS] = {
+        "ibfs", "idfs",
+        "lt",
+        "slt",
+        "snca",
+        "dag",
+        "snca-pf",
+        "slt-pf",
+        "ibfs-do",
+        "bitset",
+        "slt-halve", "slt-split",
+        "lt-halve", "lt-split",
+        "snca-halve", "snca-split",
+        "snca-sized", "snca-sized-halve", "snca-sized-split"
+};
+
+const char *DominatorGraph::getMethodName (int method) {
+        return (method>=0 && method<DM_METHODS) ? methodnames[method] : NULL;
+}
+
+int DominatorGraph::getMethod (const char *name) {
+        if (!name) return -1;
+        for (int i=0; i<DM_METHODS; i++) {
+                if (strcmp (name, methodnames[i])==0) return i;
+        }
+        return -1;
+}
+
+void DominatorGraph::runMethod (int method, int r, int *idom) {
+        switch (method) {
+                case DM_IBFS: ibfs (r, idom); break;
+                case DM_IDFS: idfs (r, idom); break;
+                case DM_LT:   lt   (r, idom); break;
+                case DM_SLT:  slt  (r, idom); break;
+                case DM_SNCA: snca (r, idom); break;
+                case DM_DAG:  dag  (r, idom); break;
+                case DM_SNCAPF: sncapf (r, idom); break;
+                case DM_SLTPF:  sltpf  (r, idom); break;
+                case DM_IBFSDO: ibfs (r, idom, true); break;
+                case DM_BITSET: bitset (r, idom); break;
+                case DM_SLTHALVE: sltLinkEval (r, idom, LE_HALVE, LE_SIMPLE); break;
+                case DM_SLTSPLIT: sltLinkEval (r, idom, LE_SPLIT, LE_SIMPLE); break;
+                case DM_LTHALVE:  sltLinkEval (r, idom, LE_HALVE, LE_SIZED); break;
+                case DM_LTSPLIT:  sltLinkEval (r, idom, LE_SPLIT, LE_SIZED); break;
+                case DM_SNCAHALVE: sncaLinkEval (r, idom, LE_HALVE, LE_SIMPLE); break;
+                case DM_SNCASPLIT: sncaLinkEval (r, idom, LE_SPLIT, LE_SIMPLE); break;
+                case DM_SNCASIZED: sncaLinkEval (r, idom, LE_COMPRESS, LE_SIZED); break;
+                case DM_SNCASIZEDHALVE: sncaLinkEval (r, idom, LE_HALVE, LE_SIZED); break;
+                case DM_SNCASIZEDSPLIT: sncaLinkEval (r, idom, LE_SPLIT, LE_SIZED); break;
+                default: break;
+        }
+}
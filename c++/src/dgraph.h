@@ -5,13 +5,127 @@
 #include <stdlib.h>
 #include <assert.h> 
 #include <math.h>
+#include "mem_policy.h"
+#include "dom_tree.h"
+#ifdef PHASES
+#include <time.h>
+#endif
+
+/*--------------------------------------------------------------------
+ | DG_INLINE: always inlined, even without optimization (the default
+ | build), for the small accessors the inner loops call once per arc
+ *-------------------------------------------------------------------*/
+#ifdef __GNUC__
+#define DG_INLINE inline __attribute__((always_inline))
+#else
+#define DG_INLINE inline
+#endif
+
+/*-----------------------------------------------------------------
+ | iterators over an adjacency list:
+ | - ArcIterator: plain lists (a range of ints), the default
+ | - PackedArcIterator: compressed lists (sorted, stored as varint-
+ |   encoded gaps; see DominatorGraph::compressArcs)
+ | - AnyArcIterator: either one, decided per list; for output,
+ |   checks and the graph-view model, not for the algorithms
+ | The algorithms are templates on the iterator and pick it once
+ | per call, so plain graphs do not pay for the decoding.
+ *----------------------------------------------------------------*/
+
+class ArcIterator {
+	private:
+		const int *p, *stop;
+
+	public:
+		DG_INLINE ArcIterator (const int *_p, const int *_stop) {p = _p; stop = _stop;}
+
+		//next neighbor in w; false if there are no more
+		DG_INLINE bool next (int &w) {
+			if (p==stop) return false;
+			w = *(p++);
+			return true;
+		}
+};
+
+//adds the next varint-encoded gap of b to last
+static DG_INLINE int decodeGap (const unsigned char *&b, int &last) {
+	unsigned int x = *(b++);
+	if (x & 0x80) {
+		unsigned int c;
+		int shift = 7;
+		x &= 0x7f;
+		do {
+			c = *(b++);
+			x |= (c & 0x7f) << shift;
+			shift += 7;
+		} while (c & 0x80);
+	}
+	return last += x;
+}
+
+class PackedArcIterator {
+	private:
+		const unsigned char *b, *bstop;
+		int last; //last neighbor decoded
+
+	public:
+		DG_INLINE PackedArcIterator (const unsigned char *_b, const unsigned char *_bstop) {
+			b = _b; bstop = _bstop;
+			last = 0;
+		}
+
+		DG_INLINE bool next (int &w) {
+			if (b==bstop) return false;
+			w = decodeGap (b, last);
+			return true;
+		}
+};
+
+class AnyArcIterator {
+	private:
+		const unsigned char *b, *bstop;
+		int last; //last neighbor decoded (-1 for a plain list)
+
+	public:
+		inline AnyArcIterator (const int *p, const int *stop) {
+			b = (const unsigned char *)p;
+			bstop = (const unsigned char *)stop;
+			last = -1;
+		}
+
+		inline AnyArcIterator (const unsigned char *_b, const unsigned char *_bstop) {
+			b = _b; bstop = _bstop;
+			last = 0;
+		}
+
+		inline bool next (int &w) {
+			if (b==bstop) return false;
+			if (last<0) {
+				w = *(const int *)b;
+				b += sizeof(int);
+				return true;
+			}
+			w = decodeGap (b, last);
+			return true;
+		}
+};
+
+#ifdef READ_DFS_FILES
+//searches read from files (debugging; dgraph.cpp)
+int readDFS (const char *parents_filename, const char *preorder_filename, int *parent, int *pre2label, int *label2pre);
+int readPostDFS (const char *postorder_filename, int *post2label, int *label2post);
+#endif
 
 class DominatorGraph {
+	friend class KernelBench; //microbenchmarks of the private kernels (kernels.cpp)
+
 	private:
 		int n; //number of vertices in the graph
 		int narcs;  //number of arcs in the graph
 		int onarcs; //original number of arcs in the graph (before duplicates are removed)
 		int source;
+		int nback;     //number of back arcs in a dfs from backroot (-1 if unknown)
+		int backroot;
 
 #ifdef COUNTOPS
 		#define incc() {ccount++;}
@@ -25,12 +139,45 @@ class DominatorGraph {
 		#define resetcounters() {}
 #endif
 
+		/*-------------------------------------------------------------
+		 | phase instrumentation: DG_PHASE(p) closes the current phase and
+		 | opens p, charging it the elapsed time (monotonic clock) and
+		 | the comparisons counted meanwhile; DG_PHASEEND() closes the
+		 | current phase. Both vanish unless PHASES is defined.
+		 *------------------------------------------------------------*/
+#ifdef PHASES
+		#define DG_PHASE(p) {phaseSwitch(p);}
+		#define DG_PHASEEND() {phaseSwitch(-1);}
+#else
+		#define DG_PHASE(p) {}
+		#define DG_PHASEEND() {}
+#endif
+
+		/*------------------------------------------------------------
+		 | software prefetching (used by the -pf variants); DG_PFDIST
+		 | is how many vertices ahead the pipeline runs
+		 *-----------------------------------------------------------*/
+		static inline void prefetch (const void *a) {
+#ifdef __GNUC__
+			__builtin_prefetch (a);
+#endif
+		}
+#ifndef DG_PFDIST
+		#define DG_PFDIST 8
+#endif
+
+		//largest graph (vertices) bitset handles itself; it uses snca above
+#ifndef BITSET_MAX
+		#define BITSET_MAX 4096
+#endif
+
 		//aggregate type for DFS parameters
 		typedef struct {
 			union {int *label2post; int *label2pre;}; 
 			union {int *post2label; int *pre2label;};
 			int next;
 			int *parent;
+			int back; //number of back arcs found (only used by rpostDFSb)
 		} DFSParams;
 
 		typedef DFSParams PostDFSParams;
@@ -44,19 +191,38 @@ class DominatorGraph {
 		typedef union {
 			int value;
 			int *ptr;
+			unsigned char *bptr; //compressed representation
 		} intptr;
 
 		intptr *first_in;  //first_in[v]: pointer to first element in 'in_arcs' representing a neighbor of v
 		intptr *first_out; //first_out[v]: pointer to first element in 'out_arcs' representing a neighbor of v
 		int *in_arcs;   //list of incoming arcs (arcs with the same destination are contiguous)
 		int *out_arcs;  //list of outgoing arcs (arcs with different destinations are contiguous)
+		unsigned char *in_bytes;  //compressed in_arcs (NULL unless compressed)
+		unsigned char *out_bytes; //compressed out_arcs (NULL unless compressed)
+		bool compressed;
+		long long *weights; //weights[v] (NULL: all 1)
+		char *storage;   //one block holding first_in/first_out/in_arcs/out_arcs (NULL: separate blocks)
+		bool ownstorage; //free storage on destruction? (a series arena is owned by its first graph)
+		bool lowmem;     //slt/lt/snca with the packed scratch layouts (see setLowMemory)
+
+		unsigned char *encodeArcs (intptr *first, int *arcs);
+
+		//arcs out of v (bytes if compressed); only used for cost estimates
+		inline int getOutSize (int v) const {
+			if (compressed) return (int)(first_out[v+1].bptr - first_out[v].bptr);
+			return (int)(first_out[v+1].ptr - first_out[v].ptr);
+		}
 
+		//plain representation only
 		inline void getOutBounds (int v, int * &start, int * &stop) const  {
+			assert (!compressed);
 			start = first_out[v].ptr;
 			stop = first_out[v+1].ptr;
 		}
 
 		inline void getInBounds (int v, int *&start, int *&stop) const {
+			assert (!compressed);
 			start = first_in[v].ptr;
 			stop = first_in[v+1].ptr;
 		}
@@ -64,24 +230,73 @@ class DominatorGraph {
 		inline int *getFirstIn(int v) const {return first_in[v].ptr;}
 		inline int *getBoundIn(int v) const {return first_in[v+1].ptr;}
 
+		/*----------------------------------------------------------------
+		 | neighbor lists for the algorithms, which are templates on the
+		 | iterator (ArcIterator for plain graphs, PackedArcIterator for
+		 | compressed ones; specializations below the class)
+		 *---------------------------------------------------------------*/
+		template <class Iterator> Iterator outArcs (int v) const;
+		template <class Iterator> Iterator inArcs (int v) const;
+
 
 		/*----------------
 		 | initialization 
 		 *---------------*/
 		void deleteAll() {
-			if (first_in) delete [] first_in;
-			if (first_out) delete [] first_out;
-			if (in_arcs) delete [] in_arcs;
-			if (out_arcs) delete [] out_arcs;
+			if (storage) {
+				if (ownstorage) mpDelete (storage);
+			} else {
+				if (first_in) mpDelete (first_in);
+				if (first_out) mpDelete (first_out);
+				if (in_arcs) mpDelete (in_arcs);
+				if (out_arcs) mpDelete (out_arcs);
+			}
+			if (in_bytes) mpDelete (in_bytes);
+			if (out_bytes) mpDelete (out_bytes);
+			if (weights) mpDelete (weights);
+			weights = NULL;
 		}
 
 		void reset() {
 			icount=scount=ccount=0;
+			bfsarcs=0;
+			bfstd=bfsbu=0;
 			in_arcs = out_arcs = NULL;
+			in_bytes = out_bytes = NULL;
+			compressed = false;
+			storage = NULL;
+			ownstorage = false;
 			first_out = first_in = NULL;
+			weights = NULL;
 			n = narcs = source = 0;
+			nback = -1;
+			backroot = 0;
+			resetPhases();
+		}
+
+#ifdef PHASES
+		int curphase;          //phase being timed (-1 if none)
+		double phasestart;     //when it started
+		long long phaseccount; //ccount when it started
+
+		static inline double phaseClock() {
+			struct timespec ts;
+			clock_gettime (CLOCK_MONOTONIC, &ts);
+			return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
 		}
 
+		inline void phaseSwitch (int p) {
+			double now = phaseClock();
+			if (curphase>=0) {
+				phasetime[curphase] += now - phasestart;
+				phaseops[curphase] += ccount - phaseccount;
+			}
+			curphase = p;
+			phasestart = now;
+			phaseccount = ccount;
+		}
+#endif
+
 		inline int log2 (int x) {
 			return (int) ceil (log((double)x) / log(2.0));
 		}
@@ -173,6 +388,47 @@ class DominatorGraph {
 			}
 		}
 
+		/*-----------------------------------------------------------
+		 | compact kernels (dgraph_compact.cpp): the dfs of snca and
+		 | slt on arrays of a narrower index type, and the entry
+		 | point that runs the templates with it
+		 *----------------------------------------------------------*/
+		template <class Index, class Iterator> void rpreDFSc (int v, Index *label2pre, Index *pre2label, Index *parent, int &next);
+		template <class Index, class Iterator> int preDFSc (int r, Index *label2pre, Index *pre2label, Index *parent);
+		template <class Iterator> void compactT (int k, int r, int *idom, char *scratch);
+
+		/*--------------------------------------------------------------
+		 | three-stage prefetch pipeline for the semidominator loops:
+		 | vertex j (in preorder) will be processed soon, so fetch its
+		 | in-arc bounds (stage 1), the pre-ids of its in-neighbors 
+		 | (stage 2), and the parent/label entries of the non-ancestor 
+		 | ones (stage 3); each stage relies on the previous one
+		 *-------------------------------------------------------------*/
+
+		inline void prefetchBounds (int j, const int *pre2label) const {
+			if (j>1) prefetch (&first_in[pre2label[j]]);
+		}
+
+		template <class Iterator> inline void prefetchPre (int j, const int *pre2label, const int *label2pre) const {
+			if (j<=1) return;
+			int nbr;
+			Iterator a = inArcs<Iterator> (pre2label[j]);
+			while (a.next(nbr)) prefetch (&label2pre[nbr]);
+		}
+
+		template <class Iterator> inline void prefetchTargets (int j, const int *pre2label, const int *label2pre, const int *parent, const int *label) const {
+			if (j<=1) return;
+			int nbr;
+			Iterator a = inArcs<Iterator> (pre2label[j]);
+			while (a.next(nbr)) {
+				int v = label2pre[nbr];
+				if (v>j) {
+					prefetch (&parent[v]);
+					prefetch (&label[v]);
+				}
+			}
+		}
+
 		inline void lt_neg_compress(int v, int *ancestor, int *semi, int *label) {
 			int t;
 			incc();
@@ -188,45 +444,157 @@ class DominatorGraph {
 		void lt_neg_link(int v, int w, int *semi, int *label, int *ancestor, int *size);
 		int lt_neg_eval (int v, int *ancestor, int *semi, int *label);
 
-
-		/*-------------------------------------------------------------------
-		 | finds the nearest common ancestor of v1 and v2 in the approximate
-	     | dominators tree represented by the array dom. First function uses
-		 | post-ids, the second uses pre-ids.
-		 *------------------------------------------------------------------*/		
-		
-		 inline int intersect (int v1, int v2, int *dom) {
-			do {
-				incc(); //outer test
-				while (v1<v2) {incc(); v1 = dom[v1];}
-				incc(); //failed above
-				while (v2<v1) {incc(); v2 = dom[v2];}
-				incc(); //failed above
-			} while (v1!=v2);
-			return v1;
+		/*------------------------------------------------------------
+		 | bodies of the other algorithms, for one arc iterator (the
+		 | public members of the same names pick it; slt, lt, snca,
+		 | ibfs and idfs run the templates of dgraph_view.h instead)
+		 *-----------------------------------------------------------*/
+		template <class Iterator> void dag (int r, int *idom);
+		template <class Iterator> void sncapf (int r, int *idom);
+		template <class Iterator> void sltpf (int r, int *idom);
+		template <class Iterator> void bitset (int r, int *idom);
+		template <class Iterator> int semi_dominators (int r);
+
+		/*------------------------------------------------------------------
+		 | nearest common ancestor in a tree that grows by leaf additions,
+		 | using skew-binary jump pointers: each vertex v keeps its parent
+		 | dom[v], its depth and a pointer jump[v] to an ancestor; queries
+		 | take O(log n) steps and adding a leaf takes O(1) time.
+		 *-----------------------------------------------------------------*/
+
+		inline void jumpAddLeaf (int v, int p, int *dom, int *depth, int *jump) {
+			int j = jump[p];
+			dom[v] = p;
+			depth[v] = depth[p] + 1;
+			jump[v] = (depth[p]-depth[j] == depth[j]-depth[jump[j]]) ? jump[j] : p;
 		}
 
-		inline int preIntersect(int v1, int v2, int *dom) {
-			do {
-				incc();
-				while (v1>v2) {incc(); v1 = dom[v1];}
+		inline int jumpNCA (int v1, int v2, int *dom, int *depth, int *jump) {
+			if (depth[v1] < depth[v2]) {int t = v1; v1 = v2; v2 = t;}
+			while (depth[v1] > depth[v2]) { //level ancestor of v1
 				incc();
-				while (v2>v1) {incc(); v2 = dom[v2];}
+				v1 = (depth[jump[v1]] >= depth[v2]) ? jump[v1] : dom[v1];
+			}
+			while (v1 != v2) { //same depth: jumps have the same depth as well
 				incc();
-			} while (v1!=v2);
+				if (jump[v1] != jump[v2]) {v1 = jump[v1]; v2 = jump[v2];}
+				else {v1 = dom[v1]; v2 = dom[v2];}
+			}
 			return v1;
-	    }
+		}
 
 	
 	public:
-		int ccount; //comparison counter
-		int icount; //iteration counter
-		int scount; //sdom=parent counter
+		long long ccount; //comparison counter
+		long long icount; //iteration counter
+		long long scount; //sdom=parent counter
+		long long bfsarcs; //arcs scanned by the last bfs (preBFSp: see getOutSize)
+		int bfstd, bfsbu;  //top-down and bottom-up levels in the last preBFSdo
+
+		/*-------------------------------------------------------
+		 | phases (only measured if compiled with PHASES); times
+		 | and counts accumulate over runs until resetPhases()
+		 *------------------------------------------------------*/
+		typedef enum {
+			PH_INIT,   //initialization of arrays
+			PH_SEARCH, //dfs/bfs
+			PH_SEMI,   //semidominators (scanning incoming arcs)
+			PH_BUCKET, //bucket processing
+			PH_ITER,   //iterations of the iterative algorithms
+			PH_NCA,    //nca computations building the dominator tree
+			PH_IDOM,   //recovery of idoms (relative to absolute, relabeling)
+			NPHASES
+		} Phase;
+
+		double phasetime[NPHASES]; //seconds spent in each phase
+		long long phaseops[NPHASES]; //comparisons counted in each phase (COUNTOPS only)
+		static const char *getPhaseName (int p) {
+			static const char *names[NPHASES] = {"init", "search", "semi", "bucket", "iter", "nca", "idom"};
+			return names[p];
+		}
+
+		void resetPhases() {
+			for (int p=0; p<NPHASES; p++) {phasetime[p] = 0.0; phaseops[p] = 0;}
+#ifdef PHASES
+			curphase = -1;
+#endif
+		}
+
+		/*------------------------------------------------------------
+		 | neighbor lists; with getNVertices, they make DominatorGraph
+		 | a model of the graph views of dgraph_view.h
+		 *-----------------------------------------------------------*/
+		typedef AnyArcIterator Iterator;
+
+		inline AnyArcIterator getOutArcs (int v) const {
+			if (compressed) return AnyArcIterator (first_out[v].bptr, first_out[v+1].bptr);
+			return AnyArcIterator (first_out[v].ptr, first_out[v+1].ptr);
+		}
+
+		inline AnyArcIterator getInArcs (int v) const {
+			if (compressed) return AnyArcIterator (first_in[v].bptr, first_in[v+1].bptr);
+			return AnyArcIterator (first_in[v].ptr, first_in[v+1].ptr);
+		}
 
 		inline int getNVertices() const {return n;}
 		inline int getNArcs() const {return narcs;}
 		inline int getOriginalNArcs() const {return onarcs;}
 		inline int getSource() const {return source;}
+		inline bool isCompressed() const {return compressed;}
+		long long getArcBytes() const; //memory used by the adjacency lists
+
+		/*---------------------------------------------------------------
+		 | the graph as the view the members run the algorithms of
+		 | dgraph_view.h on: one arc iterator (It), and the members' own
+		 | searches (diropt: preBFSdo instead of preBFSp)
+		 *--------------------------------------------------------------*/
+		template <class It> class ArcsView {
+			private:
+				DominatorGraph &g;
+				bool diropt;
+
+			public:
+				typedef It Iterator;
+
+				ArcsView (DominatorGraph &_g, bool _diropt=false) : g(_g) {diropt = _diropt;}
+
+				DG_INLINE int getNVertices() const {return g.n;}
+				DG_INLINE It getOutArcs (int v) const {return g.outArcs<It> (v);}
+				DG_INLINE It getInArcs (int v) const {return g.inArcs<It> (v);}
+
+				int preDFS (int r, int *label2pre, int *pre2label, int *parent) const {
+					int N = g.preDFSp<It> (r, label2pre, pre2label, parent);
+#ifdef READ_DFS_FILES
+					N = readDFS ("data.dimacs.parents", "data.dimacs.preorder", parent, pre2label, label2pre);
+#endif
+					return N;
+				}
+
+				//narrower arrays (the compact kernels)
+				template <class Index> int preDFS (int r, Index *label2pre, Index *pre2label, Index *parent) const {
+					return g.preDFSc<Index, It> (r, label2pre, pre2label, parent);
+				}
+
+				int postDFS (int r, int *label2post, int *post2label) const {
+					int N = g.postDFS<It> (r, label2post, post2label);
+#ifdef READ_DFS_FILES
+					N = readPostDFS ("data.dimacs.postorder", post2label, label2post);
+#endif
+					return N;
+				}
+
+				int preBFS (int r, int *label2pre, int *pre2label, int *parent) const {
+					if (diropt) return g.preBFSdo<It> (r, label2pre, pre2label, parent);
+					return g.preBFSp<It> (r, label2pre, pre2label, parent);
+				}
+		};
+
+		/*---------------------------------------------------------------
+		 | as the meter of those algorithms (see ViewMeter), the graph
+		 | counts in ccount/icount and times phases with DG_PHASE
+		 *--------------------------------------------------------------*/
+		DG_INLINE void phase (int p) {DG_PHASE(p); (void)p;}
+		DG_INLINE void phaseEnd () {DG_PHASEEND();}
 
 		/*---------
 		 | outputs 
@@ -234,12 +602,44 @@ class DominatorGraph {
 		void output (FILE *file, bool reverse);
 		void outputGraphStatistics (FILE *file);
 
+		/*------------------------------------------
+		 | cheap graph features (used for automatic
+		 | method selection); the result is cached
+		 *-----------------------------------------*/
+		int getBackArcs (int r);
+
+		/*--------------------------------------------------------
+		 | dominator tree (children, preorder, depths, sizes) from
+		 | the idom array computed by any method from r
+		 *-------------------------------------------------------*/
+		void buildTree (int r, const int *idom, DominatorTree &tree, bool parallel = false) {
+			tree.build (n, idom, r, parallel);
+		}
+
+		/*-----------------------------------------------------------
+		 | vertex weights: from 'n v w' lines of a DIMACS file or 
+		 | given to buildGraph; retained[v] is the total weight of
+		 | the vertices v dominates (itself included)
+		 *----------------------------------------------------------*/
+		void setWeights (const long long *w); //w[1..n] (copied); NULL: unweighted
+		inline bool isWeighted() const {return weights!=NULL;}
+		inline long long getWeight (int v) const {return weights ? weights[v] : 1;}
+		inline const long long *getWeights() const {return weights;}
+		void getRetained (const DominatorTree &tree, long long *retained, bool parallel = false) const {
+			tree.getRetained (weights, retained, parallel);
+		}
+
 		/*-----------------------------
 		 | initialization / destructor 
 		 *----------------------------*/
-		DominatorGraph() {reset();}
-		void buildGraph (int _nvertices, int _narcs, int _source, int *arclist, bool simplify); //from list of arcs
-		void readDimacs (const char *filename, bool reverse, bool simplify); //from file
+		DominatorGraph() {lowmem = false; reset();}
+		void buildGraph (int _nvertices, int _narcs, int _source, int *arclist, bool simplify, char *_storage=NULL, bool _own=false, const long long *_weights=NULL); //from list of arcs
+		static size_t getStorageSize (int _nvertices, int _narcs); //bytes buildGraph needs in _storage
+		void loadCSR (int _nvertices, int _narcs, int _onarcs, int _source, const int *csr, char *_storage=NULL, bool _own=false); //from a flat CSR image
+		bool writeCSR (FILE *file) const; //write the flat CSR image (uncompressed graphs only)
+		static size_t getCSRSize (int _nvertices, int _narcs); //bytes in the image
+		const char *readDimacs (const char *filename, bool reverse, bool simplify); //from file; NULL or an error message
+		void compressArcs (); //switch to the compressed representation (sorts the lists)
 		~DominatorGraph() {deleteAll();}
 
 		void destroy() {
@@ -247,29 +647,101 @@ class DominatorGraph {
 			reset();
 		}
 
-		/*---------------------------------
-		 | several variants of dfs and bfs
-		 *--------------------------------*/
-		void rpostDFS (int v, PostDFSParams &params);
+		/*---------------------------------------------------------------
+		 | several variants of dfs and bfs; the templates take the arc
+		 | iterator (the algorithms call them), the others pick it
+		 *--------------------------------------------------------------*/
+		template <class Iterator> void rpostDFS (int v, PostDFSParams &params);
+		template <class Iterator> int postDFS (int v, int *label2post, int *post2label);
 		int postDFS (int v, int *label2post, int *post2label);
 
-		void rpostDFSp (int v, PostDFSParams &params);
+		template <class Iterator> void rpostDFSp (int v, PostDFSParams &params);
+		template <class Iterator> int postDFSp (int v, int *label2post, int *post2label, int *parent);
 		int postDFSp (int v, int *label2post, int *post2label, int *parent);
 
-		void rpreDFSp (int v, PreDFSParams &params);
-		int preDFSp (int v, int *label2pre, int *pre2label, int *parent);
+		template <class Iterator> void rpostDFSb (int v, PostDFSParams &params);
+		template <class Iterator> int postDFSb (int v, int *label2post, int *post2label, int &back);
+		int postDFSb (int v, int *label2post, int *post2label, int &back);
 
+		template <class Iterator> void rpreDFSp (int v, PreDFSParams &params);
+		template <class Iterator> int preDFSp (int v, int *label2pre, int *pre2label, int *parent);
+		int preDFSp (int v, int *label2pre, int *pre2label, int *parent);
 
+		template <class Iterator> int preBFSp (int v, int *label2pre, int *pre2label, int *parent);
 		int preBFSp (int v, int *label2pre, int *pre2label, int *parent);
+		template <class Iterator> int preBFSdo (int v, int *label2pre, int *pre2label, int *parent); //direction-optimizing, parallel
+		int preBFSdo (int v, int *label2pre, int *pre2label, int *parent);
 
 		/*------------------
 		 | basic algorithms 
 		 *-----------------*/
 		 void slt (int r, int *idom);  //former slt_v4
 		 void lt (int r, int *idom);   //former lt_neg
-		 void ibfs (int r, int *idom); //former iter_v3
+		 void ibfs (int r, int *idom, bool diropt=false); //former iter_v3 (diropt: use preBFSdo)
 		 void idfs (int r, int *idom); //former iter_base
 		 void snca (int r, int *idom); //former snca_v2
+		 void dag (int r, int *idom);  //acyclic graphs only (falls back to lt)
+		 void sncapf (int r, int *idom); //snca with software prefetching
+		 void sltpf (int r, int *idom);  //slt with software prefetching
+		 void bitset (int r, int *idom); //dataflow on bit vectors (small graphs; snca above BITSET_MAX)
+		 static const char *getBitsetISA (); //instruction set of bitset's intersections
+
+		/*-------------------------------------------------------------
+		 | link-eval policies: how eval shortens forest paths (full
+		 | compression, halving or splitting) and how link joins
+		 | trees (simply, to the dfs parent, or by size); slt is
+		 | sltLinkEval (LE_COMPRESS, LE_SIMPLE), lt is sltLinkEval
+		 | (LE_COMPRESS, LE_SIZED), snca is sncaLinkEval (LE_COMPRESS,
+		 | LE_SIMPLE)
+		 *------------------------------------------------------------*/
+		typedef enum {LE_COMPRESS, LE_HALVE, LE_SPLIT} PathPolicy;
+		typedef enum {LE_SIMPLE, LE_SIZED} LinkPolicy;
+		void sltLinkEval (int r, int *idom, PathPolicy path, LinkPolicy link);
+		void sncaLinkEval (int r, int *idom, PathPolicy path, LinkPolicy link);
+	private:
+		template <bool packed, class Iterator> void sltPolicies (int r, int *idom, PathPolicy path, LinkPolicy link);
+		template <bool packed, class Iterator> void sncaPolicies (int r, int *idom, PathPolicy path, LinkPolicy link);
+	public:
+
+		/*----------------------------------------------------------------
+		 | low-memory mode (slt, lt, snca and their link-eval variants):
+		 | scratch arrays whose lifetimes do not overlap share storage,
+		 | pre2label is rebuilt from label2pre instead of being kept to
+		 | the end, and lt's sizes take 16 bits; scratch goes from 6 to
+		 | 4 ints per vertex (slt), 8 to 4.5 (lt) and 5 to 4 (snca), for
+		 | one extra pass over the vertices
+		 *---------------------------------------------------------------*/
+		void setLowMemory (bool on) {lowmem = on;}
+		bool getLowMemory () const {return lowmem;}
+
+		/*------------------------------------------------------------
+		 | compact kernels: snca and slt with 16-bit per-vertex state
+		 | (graphs with at most COMPACT_MAX vertices), working in a
+		 | caller's scratch block of getCompactScratch(maxn) bytes;
+		 | compactBatch runs a list of graphs back to back in one
+		 | block (larger graphs use snca/slt) and returns how many
+		 | used the compact kernels
+		 *-----------------------------------------------------------*/
+		typedef unsigned short Compact;
+		typedef enum {COMPACT_SNCA, COMPACT_SLT} CompactKernel;
+		static const int COMPACT_MAX = 65534;
+		inline bool fitsCompact() const {return n <= COMPACT_MAX;}
+		static size_t getCompactScratch (int maxn);
+		void compact (CompactKernel k, int r, int *idom, void *scratch);
+		static int compactBatch (CompactKernel k, DominatorGraph *glist, int count, int *const *idoms, void *scratch);
+
+		/*--------------------------------------------------------------
+		 | dominator methods by name, the one list behind dom's methods
+		 | and libdominators' (whose method codes these are): getMethod
+		 | returns -1 for an unknown name, getMethodName NULL for an
+		 | unknown code; runMethod ignores unknown codes
+		 *-------------------------------------------------------------*/
+		typedef enum {DM_IBFS, DM_IDFS, DM_LT, DM_SLT, DM_SNCA, DM_DAG, DM_SNCAPF, DM_SLTPF, DM_IBFSDO, DM_BITSET,
+		              DM_SLTHALVE, DM_SLTSPLIT, DM_LTHALVE, DM_LTSPLIT, DM_SNCAHALVE, DM_SNCASPLIT,
+		              DM_SNCASIZED, DM_SNCASIZEDHALVE, DM_SNCASIZEDSPLIT, DM_METHODS} Method;
+		static const char *getMethodName (int method);
+		static int getMethod (const char *name);
+		void runMethod (int method, int r, int *idom);
 
 
 		/*---------------------
@@ -278,6 +750,7 @@ class DominatorGraph {
 		int semi_dominators (int r);
 		int run_dfs (int r); 
 		int run_bfs (int r);
+		int run_bfsdo (int r);
 
 		/*-----------------
 		 | link-eval stuff
@@ -287,4 +760,9 @@ class DominatorGraph {
 
 };
 
+template <> DG_INLINE ArcIterator DominatorGraph::outArcs<ArcIterator> (int v) const {return ArcIterator (first_out[v].ptr, first_out[v+1].ptr);}
+template <> DG_INLINE ArcIterator DominatorGraph::inArcs<ArcIterator> (int v) const {return ArcIterator (first_in[v].ptr, first_in[v+1].ptr);}
+template <> DG_INLINE PackedArcIterator DominatorGraph::outArcs<PackedArcIterator> (int v) const {return PackedArcIterator (first_out[v].bptr, first_out[v+1].bptr);}
+template <> DG_INLINE PackedArcIterator DominatorGraph::inArcs<PackedArcIterator> (int v) const {return PackedArcIterator (first_in[v].bptr, first_in[v+1].bptr);}
+
 #endif
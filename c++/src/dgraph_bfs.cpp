@@ -0,0 +1,138 @@
+#include "dgraph.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*-------------------------------------------------------------------
+ | direction-optimizing bfs (top-down/bottom-up), parallel if built
+ | with OpenMP; produces the same kind of output as preBFSp:
+ | - vertices are numbered level by level, so parent[i]<i
+ | - label2pre[v]==0 iff v is unreachable
+ | - parent is indexed by pre-id and parent[1]==1
+ | Within a level, the numbering depends on thread scheduling.
+ |
+ | Each level is either
+ | - top-down: every frontier vertex scans its out-arcs and claims
+ |   unvisited heads (with compare-and-swap), or
+ | - bottom-up: every unvisited vertex scans its in-arcs until it
+ |   finds one from the frontier (no synchronization needed);
+ | bottom-up is used while the frontier has more than 1/BFS_ALPHA
+ | of the unexplored arcs, as long as it has more than 1/BFS_BETA
+ | of the vertices.
+ *------------------------------------------------------------------*/
+
+#define BFS_ALPHA 14
+#define BFS_BETA 24
+#define BFS_BATCH 64 //vertices buffered by a thread before they get ids
+
+//appends a batch of newly found vertices to the queue (pre2label)
+static inline void flushBatch (int *batch, int *bparent, int k, int &last, int *label2pre, int *pre2label, int *parent) {
+	int pos;
+#ifdef _OPENMP
+	pos = __sync_fetch_and_add (&last, k);
+#else
+	pos = last;
+	last += k;
+#endif
+	for (int j=0; j<k; j++) {
+		int id = pos + j + 1;
+		pre2label[id] = batch[j];
+		label2pre[batch[j]] = id;
+		parent[id] = bparent[j];
+	}
+}
+
+template <class Iterator> int DominatorGraph::preBFSdo (int r, int *label2pre, int *pre2label, int *parent) {
+	for (int v=n; v>0; v--) label2pre[v] = 0; //everybody unreachable
+
+	//process first vertex
+	parent[1] = 1;    //mark as self-parent
+	label2pre[r] = 1; 
+	pre2label[1] = r; //used as a queue, one level after the other
+	int first = 1, last = 1;
+	long long unexplored = narcs; //arcs out of unvisited vertices (estimate if compressed)
+	long long scanned = 0;        //arcs scanned
+	bfstd = bfsbu = 0;
+
+	while (first<=last) {
+		int levelend = last; //current level is [first,levelend]
+		long long mf = 0;    //arcs out of the frontier
+		for (int i=first; i<=levelend; i++) mf += getOutSize (pre2label[i]);
+		unexplored -= mf;
+		bool bottomup = (mf > unexplored / BFS_ALPHA) && ((long long)(levelend-first+1) * BFS_BETA > n);
+
+		if (bottomup) {
+			bfsbu++;
+			#pragma omp parallel reduction(+:scanned)
+			{
+				int batch[BFS_BATCH], bparent[BFS_BATCH], k = 0;
+				#pragma omp for schedule(dynamic,1024)
+				for (int v=1; v<=n; v++) {
+					if (label2pre[v]) continue;
+					int nbr;
+					Iterator a = inArcs<Iterator> (v);
+					while (a.next(nbr)) {
+						scanned++;
+						int l = label2pre[nbr]; //may be set concurrently (to an id > levelend)
+						if (l>=first && l<=levelend) {
+							batch[k] = v;
+							bparent[k++] = l;
+							if (k==BFS_BATCH) {flushBatch (batch, bparent, k, last, label2pre, pre2label, parent); k = 0;}
+							break;
+						}
+					}
+				}
+				if (k) flushBatch (batch, bparent, k, last, label2pre, pre2label, parent);
+			}
+		} else {
+			bfstd++;
+			#pragma omp parallel reduction(+:scanned)
+			{
+				int batch[BFS_BATCH], bparent[BFS_BATCH], k = 0;
+				#pragma omp for schedule(dynamic,64)
+				for (int i=first; i<=levelend; i++) {
+					int nbr;
+					Iterator a = outArcs<Iterator> (pre2label[i]);
+					while (a.next(nbr)) {
+						scanned++;
+						if (label2pre[nbr]) continue;
+#ifdef _OPENMP
+						if (!__sync_bool_compare_and_swap (&label2pre[nbr], 0, -1)) continue; //claimed by someone else
+#else
+						label2pre[nbr] = -1;
+#endif
+						batch[k] = nbr;
+						bparent[k++] = i;
+						if (k==BFS_BATCH) {flushBatch (batch, bparent, k, last, label2pre, pre2label, parent); k = 0;}
+					}
+				}
+				if (k) flushBatch (batch, bparent, k, last, label2pre, pre2label, parent);
+			}
+		}
+		first = levelend + 1;
+	}
+	bfsarcs = scanned;
+	return last; //number of vertices visited
+}
+
+template int DominatorGraph::preBFSdo<ArcIterator> (int, int *, int *, int *);
+template int DominatorGraph::preBFSdo<PackedArcIterator> (int, int *, int *, int *);
+
+int DominatorGraph::preBFSdo (int r, int *label2pre, int *pre2label, int *parent) {
+	if (compressed) return preBFSdo<PackedArcIterator> (r, label2pre, pre2label, parent);
+	return preBFSdo<ArcIterator> (r, label2pre, pre2label, parent);
+}
+
+
+int DominatorGraph::run_bfsdo (int r) {
+	int bsize = n+1;
+	int *buffer = mpNew<int> (3*bsize);
+	int *pre2label = &buffer[0];
+	int *label2pre = &buffer[bsize];
+	int *parent    = &buffer[2*bsize];
+
+	int visited = preBFSdo (r, label2pre, pre2label, parent);
+
+	mpDelete (buffer);
+	return visited;
+}
@@ -0,0 +1,237 @@
+#include "dgraph.h"
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BITSET_X86
+#endif
+
+/*------------------------------------------------------------------
+ | Bit-parallel dataflow dominators (bitset)
+ | - the textbook formulation: Dom(r) = {r} and, for every other
+ |   vertex, Dom(w) = {w} + intersection of Dom(v) over arcs (v,w),
+ |   iterated to a fixed point from the full sets
+ | - sets are bit vectors indexed by post-id and vertices are
+ |   visited in reverse post-order (acyclic graphs need one pass
+ |   plus a check); intersections are word-parallel, with AVX-512
+ |   or AVX2 when the processor has them
+ | - dominators are dfs ancestors, whose post-ids are larger, so
+ |   the set of w lies within {post(w)..N}: rows are stored from
+ |   the block holding post(w) on (a triangle, half of N^2 bits)
+ | - a row is first computed as a copy of an already computed
+ |   predecessor (the dfs parent always is one); predecessors not
+ |   yet computed (back arcs) still hold {post(v)..N}, which
+ |   contains the result, so they are skipped
+ | - sets only shrink, so later passes intersect each one in
+ |   place, and only with the sets that changed since it was last
+ |   computed (it is already contained in the others); timestamps
+ |   tell which ones did, so a pass that changes nothing is cheap
+ | - memory and time per intersection grow with N^2; above
+ |   BITSET_MAX vertices we fall back to snca
+ | - idom(w) is the strict dominator of w closest to it, i.e. the
+ |   one with the smallest post-id
+ *-----------------------------------------------------------------*/
+
+typedef unsigned long long Word;
+static const int WORDBITS = 64;
+static const int ROWALIGN = 8; //words per row are a multiple of this (512 bits)
+
+//dst &= src; true iff some bit of dst was cleared (words: a multiple of ROWALIGN)
+typedef bool (*AndFunction) (Word *dst, const Word *src, int words);
+
+static bool andWords (Word *dst, const Word *src, int words) {
+	Word cleared = 0;
+	for (int k=0; k<words; k++) {
+		cleared |= dst[k] & ~src[k];
+		dst[k] &= src[k];
+	}
+	return cleared!=0;
+}
+
+#ifdef BITSET_X86
+__attribute__((target("avx2")))
+static bool andAVX2 (Word *dst, const Word *src, int words) {
+	__m256i cleared = _mm256_setzero_si256();
+	for (int k=0; k<words; k+=4) {
+		__m256i a = _mm256_loadu_si256 ((const __m256i *)&dst[k]);
+		__m256i b = _mm256_loadu_si256 ((const __m256i *)&src[k]);
+		cleared = _mm256_or_si256 (cleared, _mm256_andnot_si256 (b, a));
+		_mm256_storeu_si256 ((__m256i *)&dst[k], _mm256_and_si256 (a, b));
+	}
+	return !_mm256_testz_si256 (cleared, cleared);
+}
+
+__attribute__((target("avx512f")))
+static bool andAVX512 (Word *dst, const Word *src, int words) {
+	__m512i cleared = _mm512_set1_epi64 (0);
+	for (int k=0; k<words; k+=8) {
+		__m512i a = _mm512_loadu_si512 ((const void *)&dst[k]);
+		__m512i b = _mm512_loadu_si512 ((const void *)&src[k]);
+		__m512i c = _mm512_and_si512 (a, b);
+		cleared = _mm512_or_si512 (cleared, _mm512_xor_si512 (a, c)); //bits of a not in b
+		_mm512_storeu_si512 ((void *)&dst[k], c);
+	}
+	return _mm512_test_epi64_mask (cleared, cleared)!=0;
+}
+#endif
+
+//widest intersection the processor supports (rows are padded for it)
+static AndFunction getAnd () {
+#ifdef BITSET_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports ("avx512f")) return andAVX512;
+	if (__builtin_cpu_supports ("avx2")) return andAVX2;
+#endif
+	return andWords;
+}
+
+const char *DominatorGraph::getBitsetISA () {
+	AndFunction f = getAnd();
+#ifdef BITSET_X86
+	if (f==andAVX512) return "avx512";
+	if (f==andAVX2) return "avx2";
+#endif
+	return (f==andWords) ? "scalar" : "unknown";
+}
+
+//first word of the row of post-id i (rows start at a block boundary)
+static inline int firstWord (int i) {return (i / (WORDBITS*ROWALIGN)) * ROWALIGN;}
+
+/*---------------------------------------------------------------------
+ | row (words si..) becomes its intersection (or, if copy, a copy)
+ | of vrow (words sv..); true iff a bit of row was cleared. Words in
+ | which vrow has no data are zero in vrow's set.
+ *--------------------------------------------------------------------*/
+static inline bool meetRows (AndFunction intersect, Word *row, int si, const Word *vrow, int sv, int words, bool copy) {
+	bool cleared = false;
+	if (sv > si) {
+		for (int k=0; k<sv-si; k++) {
+			if (row[k]) cleared = true;
+			row[k] = 0;
+		}
+		row += sv-si;
+		si = sv;
+	} else vrow += si-sv;
+	if (copy) {
+		memcpy (row, vrow, (words-si) * sizeof(Word));
+		return true;
+	}
+	return intersect (row, vrow, words-si) || cleared;
+}
+
+//lowest set bit of row (words si..) above bit i (0 if there is none)
+static inline int nextBit (const Word *row, int si, int i, int words) {
+	int k = i / WORDBITS;
+	int b = i % WORDBITS;
+	Word w = (b==WORDBITS-1) ? 0 : (row[k-si] & (~(Word)0 << (b+1)));
+	while (!w) {
+		if (++k==words) return 0;
+		w = row[k-si];
+	}
+#ifdef __GNUC__
+	return k*WORDBITS + __builtin_ctzll (w);
+#else
+	int j = 0;
+	while (!(w & 1)) {w >>= 1; j++;}
+	return k*WORDBITS + j;
+#endif
+}
+
+template <class Iterator> void DominatorGraph::bitset (int r, int *idom) {
+	if (n > BITSET_MAX) {
+		snca (r, idom);
+		return;
+	}
+	static const AndFunction intersect = getAnd();
+
+	int bsize = n+1;
+	int *buffer = mpNew<int> (4*bsize);
+	int *post2label = &buffer[0];
+	int *rowat      = &buffer[bsize];   //offset of each row (in words)
+	int *changedat  = &buffer[2*bsize]; //when the set last changed
+	int *computedat = &buffer[3*bsize]; //when it was last computed (-1: never)
+	int *label2post = idom; //idom will not be used until later
+
+	resetcounters();
+	DG_PHASE(PH_SEARCH);
+	int N = postDFS<Iterator> (r, label2post, post2label);
+
+	//rows for post-ids 1..N (bit j of row i: j dominates i); the root's is {N}
+	DG_PHASE(PH_INIT);
+	int words = firstWord (N) + ROWALIGN;
+	int total = 0;
+	for (int i=1; i<=N; i++) {
+		rowat[i] = total;
+		total += words - firstWord (i);
+		changedat[i] = 0;
+		computedat[i] = -1;
+	}
+	Word *sets = mpNew<Word> (total);
+	Word *root = &sets[rowat[N]];
+	memset (root, 0, (words - firstWord (N)) * sizeof(Word));
+	root[N/WORDBITS - firstWord (N)] = (Word)1 << (N%WORDBITS);
+	computedat[N] = 0;
+	int clock = 0;
+
+	/*-----------
+	 | main loop
+	 *----------*/
+	DG_PHASE(PH_ITER);
+	bool changed;
+	do {
+		inci(); //increment number of iterations (operation count)
+		changed = false;
+
+		for (int i=N-1; i>0; i--) { //reverse post-order
+			Word *row = &sets[rowat[i]];
+			int si = firstWord (i);
+			bool first = (computedat[i] < 0);
+			bool cleared = first;
+
+			//i itself leaves the set while the predecessors are met
+			Word self = (Word)1 << (i%WORDBITS);
+			if (!first) row[i/WORDBITS - si] &= ~self;
+
+			int nbr;
+			Iterator a = inArcs<Iterator> (post2label[i]);
+			while (a.next(nbr)) {
+				int v = label2post[nbr]; //v is the source of the arc
+				incc();
+				if (!v) continue; //unreachable
+				if (first) {
+					if (computedat[v] < 0) continue; //still {v..N}
+					meetRows (intersect, row, si, &sets[rowat[v]], firstWord (v), words, computedat[i] < 0);
+					computedat[i] = 0; //the row holds data now
+				} else if (changedat[v] > computedat[i]) {
+					if (meetRows (intersect, row, si, &sets[rowat[v]], firstWord (v), words, false)) cleared = true;
+				}
+			}
+			row[i/WORDBITS - si] |= self;
+
+			if (cleared) {
+				changedat[i] = ++clock;
+				changed = true;
+			}
+			computedat[i] = clock;
+		}
+	} while (changed);
+
+	/*-----------------------------------------------------------
+	 | restore idoms: unreachable nodes are already zero because
+	 | array is shared with label2post
+	 *----------------------------------------------------------*/
+	DG_PHASE(PH_IDOM);
+	for (int i=N-1; i>0; i--) {
+		int d = nextBit (&sets[rowat[i]], firstWord (i), i, words);
+		idom[post2label[i]] = post2label[d];
+	}
+	idom[r] = r;
+	DG_PHASEEND();
+
+	mpDelete (sets);
+	mpDelete (buffer);
+}
+
+void DominatorGraph::bitset (int r, int *idom) {
+	if (compressed) bitset<PackedArcIterator> (r, idom);
+	else bitset<ArcIterator> (r, idom);
+}
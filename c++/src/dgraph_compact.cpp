@@ -0,0 +1,86 @@
+#include "dgraph.h"
+#include "dgraph_view.h"
+
+/*------------------------------------------------------------------
+ | Compact kernels (snca and slt for small graphs)
+ | - snca and slt themselves (viewSncaForest and viewSltForest in
+ |   dgraph_view.h) on 16-bit arrays: their forests take Compact as
+ |   the index type, so the per-vertex state of a graph with at most
+ |   COMPACT_MAX vertices takes 12 (snca) or 14 (slt) bytes per
+ |   vertex, and graphs of a few thousand vertices keep all of it
+ |   in L1
+ | - every array is carved from a scratch block the caller owns
+ |   (getCompactScratch bytes for the largest graph), so a batch of
+ |   graphs runs back to back without allocating
+ | - idom stays an int array (it is the output); it is not shared
+ |   with label2pre as in the int versions
+ *-----------------------------------------------------------------*/
+
+typedef SimpleForest<PathCompress, true, false, DominatorGraph::Compact> CompactSncaForest;
+typedef SimpleForest<PathCompress, false, false, DominatorGraph::Compact> CompactSltForest;
+
+size_t DominatorGraph::getCompactScratch (int maxn) {
+	if (maxn > COMPACT_MAX) maxn = COMPACT_MAX;
+	size_t snca = viewSncaScratch<CompactSncaForest> (maxn);
+	size_t slt = viewSltScratch<CompactSltForest> (maxn);
+	return (snca > slt) ? snca : slt;
+}
+
+
+/*------------------------
+ | pre-dfs (with parents)
+ *-----------------------*/
+
+template <class Index, class Iterator> void DominatorGraph::rpreDFSc (int v, Index *label2pre, Index *pre2label, Index *parent, int &next) {
+	int pre_v = next;
+	pre2label[next] = (Index)v;     //v will have the next label
+	label2pre[v] = (Index)next++;   //v's label is next (and next is incremented)
+	int nbr;
+	Iterator a = outArcs<Iterator> (v);
+	while (a.next(nbr)) { //visit all outgoing neighbors
+		if (!label2pre[nbr]) {
+			parent[next] = (Index)pre_v;
+			rpreDFSc<Index, Iterator> (nbr, label2pre, pre2label, parent, next);
+		}
+	}
+}
+
+template <class Index, class Iterator> int DominatorGraph::preDFSc (int r, Index *label2pre, Index *pre2label, Index *parent) {
+	for (int w=n; w>=0; w--) label2pre[w] = 0; //everybody unvisited
+	int next = 1;
+	rpreDFSc<Index, Iterator> (r, label2pre, pre2label, parent, next);
+	return next - 1;
+}
+
+
+/*-------------------------------------------------------------
+ | entry points: one graph, or a batch sharing one scratch block
+ | (graphs too large for the compact kernels use the int ones)
+ *------------------------------------------------------------*/
+
+template <class Iterator> void DominatorGraph::compactT (int k, int r, int *idom, char *scratch) {
+	ArcsView<Iterator> view (*this);
+	resetcounters();
+	if (k==COMPACT_SLT) viewSltForest<CompactSltForest> (view, r, idom, *this, scratch);
+	else viewSncaForest<CompactSncaForest> (view, r, idom, *this, scratch);
+}
+
+void DominatorGraph::compact (CompactKernel k, int r, int *idom, void *scratch) {
+	assert (fitsCompact());
+	if (compressed) compactT<PackedArcIterator> (k, r, idom, (char *)scratch);
+	else compactT<ArcIterator> (k, r, idom, (char *)scratch);
+}
+
+int DominatorGraph::compactBatch (CompactKernel k, DominatorGraph *glist, int count, int *const *idoms, void *scratch) {
+	int compacted = 0;
+	for (int g=0; g<count; g++) {
+		DominatorGraph *graph = &glist[g];
+		int r = graph->getSource();
+		if (graph->fitsCompact()) {
+			graph->compact (k, r, idoms[g], scratch);
+			compacted++;
+		} else if (k==COMPACT_SLT) graph->slt (r, idoms[g]);
+		else graph->snca (r, idoms[g]);
+	}
+	return compacted;
+}
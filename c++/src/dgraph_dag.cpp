@@ -0,0 +1,73 @@
+#include "dgraph.h"
+
+/*------------------------------------------------------------------
+ | Dominators in acyclic graphs (dag)
+ | - a post-dfs finds a topological order (reverse post-order) and
+ |   counts back arcs; if there is any, the graph is not a DAG and
+ |   we fall back to lt
+ | - in topological order, every predecessor of a vertex w has its
+ |   idom computed before w, and idom(w) is the nearest common
+ |   ancestor of all predecessors of w in the dominator tree
+ | - the dominator tree grows one leaf at a time, so nca queries
+ |   use skew-binary jump pointers (jumpNCA)
+ | - all arrays except label2post are indexed by post-ids
+ *-----------------------------------------------------------------*/
+
+template <class Iterator> void DominatorGraph::dag (int r, int *idom) {
+	int bsize = n+1;
+	int *buffer     = mpNew<int> (4*bsize);
+	int *post2label = &buffer[0];
+	int *dom        = &buffer[bsize];
+	int *depth      = &buffer[2*bsize];
+	int *jump       = &buffer[3*bsize];
+	int *label2post = idom; //idom will not be used until later
+
+	resetcounters();
+	DG_PHASE(PH_SEARCH);
+
+	int back;
+	int N = postDFSb<Iterator> (r, label2post, post2label, back);
+	if (back) { //not acyclic
+		DG_PHASEEND();
+		mpDelete (buffer);
+		lt (r, idom);
+		return;
+	}
+
+	//the root is its own parent
+	DG_PHASE(PH_NCA);
+	dom[N] = jump[N] = N;
+	depth[N] = 0;
+
+	/*-------------------------------------------------------
+	 | process vertices in topological order; dom[v] is zero
+	 | for vertices not yet processed (post-id smaller than i)
+	 *------------------------------------------------------*/
+	for (int i=N-1; i>0; i--) {
+		int new_idom = 0;
+		int nbr;
+		Iterator a = inArcs<Iterator> (post2label[i]);
+		while (a.next(nbr)) {
+			int v = label2post[nbr]; //v is the source of the arc
+			incc();
+			if (v) new_idom = (new_idom ? jumpNCA (v, new_idom, dom, depth, jump) : v);
+		}
+		jumpAddLeaf (i, new_idom, dom, depth, jump);
+	}
+
+	/*-----------------------------------------------------------
+	 | restore idoms: unreachable nodes are already zero because
+	 | array is shared with label2post
+	 *----------------------------------------------------------*/
+	DG_PHASE(PH_IDOM);
+	idom[r] = r;
+	for (int i=N-1; i>0; i--) idom[post2label[i]] = post2label[dom[i]];
+	DG_PHASEEND();
+
+	mpDelete (buffer);
+}
+
+void DominatorGraph::dag (int r, int *idom) {
+	if (compressed) dag<PackedArcIterator> (r, idom);
+	else dag<ArcIterator> (r, idom);
+}
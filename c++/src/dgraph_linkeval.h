@@ -0,0 +1,246 @@
+#ifndef DGRAPH_LINKEVAL_H
+#define DGRAPH_LINKEVAL_H
+
+#include "dgraph.h" //incc()
+
+template <bool b, class T, class F> struct Select {typedef T Type;};
+template <class T, class F> struct Select<false, T, F> {typedef F Type;};
+
+/*--------------------------------------------------------------------
+ | Link-eval forests for slt, lt and snca (policies of the templates
+ | viewSltForest and viewSncaForest in dgraph_view.h)
+ | - a forest holds the processed vertices (pre-ids above the one
+ |   being processed); eval(v,c) returns the label with the smallest
+ |   semidominator on the forest path from v to its root, and link
+ |   adds a vertex once it has been processed
+ | - linking: SimpleForest links each vertex to its dfs parent (the
+ |   forest is the parent array, and vertices <= c are outside it);
+ |   SizedForest balances trees by size (as lt always did; the
+ |   forest is ancestor/size, with child[v] = -ancestor[v])
+ | - path policies (how eval shortens the path it walks):
+ |   PathCompress: full compression (the classic one), in two passes
+ |                 instead of recursion: up the path reversing the
+ |                 pointers, then back down compressing
+ |   PathHalve:    every vertex on the path points to its grandparent
+ |                 and the walk skips to it (one pass, a loop)
+ |   PathSplit:    same, but the walk goes on to the old parent
+ | - index type: a forest works on the algorithm's arrays, of its
+ |   Index type (int, or a narrower one for the compact kernels,
+ |   which only SimpleForest supports)
+ | - labels: SimpleForest<P,true> keeps semidominators themselves
+ |   as labels (snca), the others keep vertices compared by semi
+ | - every forest counts comparisons with incc() (COUNTOPS) in the
+ |   counter it was given
+ | - the methods are DG_INLINE, so that unoptimized builds run the
+ |   forests about as fast as hand-written loops
+ | - packed forests are for the low-memory layouts of the algorithms
+ |   (DominatorGraph::setLowMemory): there, label[x] and semi[x] of
+ |   vertices x below the one being processed may hold something
+ |   else (pre2label and parent), so labelOf/semiOf return x for
+ |   them (their label and semidominator); SizedForest also keeps
+ |   sizes in 16 bits, saturated (they only steer the balancing)
+ *-------------------------------------------------------------------*/
+
+class PathCompress {
+	private:
+		//same result and counts as the recursion (one test per vertex, one update per vertex below the last)
+		template <class Forest> static DG_INLINE void compress (Forest &f, int v) {
+			long long &ccount = f.ccount; //incc() counts in the forest's counter
+			typename Forest::Index *up = f.up, *label = f.label;
+			int x = v, below = 0, t; //0: no vertex below (v is first)
+			incc();
+			while (f.in (t=up[x])) { //up[x] points down the path for now
+				up[x] = below;
+				below = x;
+				x = t;
+				incc();
+			}
+			int root = up[x]; //x is the last vertex on the path
+			while (below) {
+				int next = up[below];
+				incc();
+				if (f.less (label[x], label[below])) label[below] = label[x];
+				up[below] = root;
+				x = below;
+				below = next;
+			}
+			(void)ccount;
+		}
+
+	public:
+		//best label on the path from v (in the forest); root: the vertex past its end
+		template <class Forest> static DG_INLINE int find (Forest &f, int v, int &root) {
+			compress (f, v);
+			root = f.up[v];
+			return f.label[v];
+		}
+};
+
+template <bool halve> class PathShorten {
+	public:
+		template <class Forest> static DG_INLINE int find (Forest &f, int v, int &root) {
+			long long &ccount = f.ccount; //incc() counts in the forest's counter
+			int best = f.label[v];
+			int x = v, t;
+			for (;;) {
+				incc();
+				if (!f.in (t=f.up[x])) {root = t; break;}
+				incc();
+				if (f.less (f.label[t], f.label[x])) f.label[x] = f.label[t]; //x covers t as well
+				f.up[x] = f.up[t];
+				incc();
+				if (f.less (f.label[x], best)) best = f.label[x];
+				if (!halve) {x = t; continue;}
+				x = f.up[x];
+				incc();
+				if (!f.in (x)) {root = x; break;}
+				incc();
+				if (f.less (f.label[x], best)) best = f.label[x];
+			}
+			(void)ccount;
+			return best;
+		}
+};
+
+typedef PathShorten<true> PathHalve;
+typedef PathShorten<false> PathSplit;
+
+
+/*----------------------------------------------------------------
+ | simple linking: up is the parent array (compressed in place),
+ | so linking is implicit; labels of values==true forests become
+ | the semidominator when the vertex is linked
+ *---------------------------------------------------------------*/
+
+template <class Path, bool values, bool packed = false, class Idx = int> class SimpleForest {
+	public:
+		typedef Idx Index;
+		static const bool PACKED = packed;
+		static const bool USESPARENT = true; //up is the algorithm's parent array
+		static int words (int n) {(void)n; return 0;} //Index entries it needs besides the algorithm's
+
+		long long &ccount;
+		Index *up, *semi, *label;
+		int c; //vertices above c are in the forest
+
+		DG_INLINE SimpleForest (long long &_ccount, Index *parent, Index *_semi, Index *_label, Index *arrays, int n) : ccount(_ccount) {
+			up = parent; semi = _semi; label = _label;
+			c = 0;
+			(void)arrays; (void)n;
+		}
+
+		DG_INLINE bool in (int x) const {return x > c;}
+		DG_INLINE bool less (int a, int b) const {return values ? (a < b) : (semi[a] < semi[b]);}
+		DG_INLINE int semiOf (int x) const {return semi[x];} //labels are only read above c
+
+		//v is known to be in the forest
+		DG_INLINE int evalLinked (int v, int _c) {
+			int root;
+			c = _c;
+			return Path::find (*this, v, root);
+		}
+
+		DG_INLINE int eval (int v, int _c) {
+			incc();
+			if (v<=_c) return v; //v is an ancestor of the vertex being processed
+			return evalLinked (v, _c);
+		}
+
+		DG_INLINE void link (int p, int w) {
+			if (values) label[w] = semi[w];
+			(void)p;
+		}
+};
+
+
+/*------------------------------------------------------------------
+ | linking by size (see the lt of Lengauer and Tarjan): roots have
+ | ancestor <= 0; eval combines the best label below the root with
+ | the root's own label
+ *-----------------------------------------------------------------*/
+
+template <class Path, bool packed = false> class SizedForest {
+	public:
+		typedef int Index;
+		typedef typename Select<packed, unsigned short, int>::Type Size;
+		static const int MAXSIZE = packed ? 65535 : 0x7fffffff;
+		static const bool PACKED = packed;
+		static const bool USESPARENT = false;
+		static int words (int n) {return (n+1) + ((n+1)*(int)sizeof(Size) + 3) / 4;}
+
+		long long &ccount;
+		int *up, *semi, *label; //up: ancestor
+		Size *size;
+		int c; //vertex being processed (packed forests)
+
+		DG_INLINE SizedForest (long long &_ccount, int *parent, int *_semi, int *_label, int *arrays, int n) : ccount(_ccount) {
+			semi = _semi; label = _label;
+			up = &arrays[0];
+			size = (Size *)&arrays[n+1];
+			for (int i=n; i>=0; i--) {
+				up[i] = 0;
+				size[i] = 1;
+			}
+			c = 0;
+			(void)parent;
+		}
+
+		DG_INLINE bool in (int x) const {return up[x] > 0;} //x is not a root
+		DG_INLINE int labelOf (int x) const {return (packed && x<c) ? x : label[x];}
+		DG_INLINE int semiOf (int x) const {return (packed && x<c) ? x : semi[x];}
+		DG_INLINE bool less (int a, int b) const {return semiOf(a) < semiOf(b);}
+
+		DG_INLINE int eval (int v, int _c) {
+			c = _c;
+			incc();
+			if (up[v] <= 0) return labelOf (v);
+			int root;
+			int lv = Path::find (*this, v, root);
+			int lav = labelOf (root);
+			incc();
+			return labelOf (less (lav, lv) ? lav : lv); //label with smallest sdom
+		}
+
+		DG_INLINE int evalLinked (int v, int c) {return eval (v, c);}
+
+		//p becomes the parent of w
+		DG_INLINE void link (int p, int w) {
+			int s = w;
+			int t = -up[s];
+
+			//join subtrees with semis greater than semi[label[w]]
+			while (semi[label[w]] < semi[label[t]]) {
+				incc();
+				if (size[s]+size[-up[t]] >= 2*size[t]) {
+					int c = up[t];
+					up[t] = s;
+					up[s] = c;
+					t = -c;
+				} else {
+					size[t] = size[s];
+					t = -up[s=up[s]=t];
+				}
+			}
+			incc(); //for the failure
+
+			label[s] = label[w];
+			if (size[p]<size[w]) { //swap s and child[p]
+				int t = -up[p];
+				up[p] = -s;
+				s = t;
+			}
+			int sum = size[p] + size[w];
+			size[p] = (Size)((sum > MAXSIZE) ? MAXSIZE : sum);
+
+			//make p the ancestor of the subtrees of s
+			while (s) {
+				incc();
+				int t = -up[s];
+				up[s] = p;
+				s = t;
+			}
+			incc(); //for the failure
+		}
+};
+
+#endif
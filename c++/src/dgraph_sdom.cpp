@@ -1,8 +1,8 @@
 #include "dgraph.h"
 
-int DominatorGraph::semi_dominators (int r) {
+template <class Iterator> int DominatorGraph::semi_dominators (int r) {
 	int bsize = n+1;
-	int *buffer = new int [5*bsize];
+	int *buffer = mpNew<int> (5*bsize);
 	int *label2pre = &buffer[0];
 	int *pre2label = &buffer[bsize];
 	int *parent    = &buffer[2*bsize];
@@ -20,14 +20,14 @@ int DominatorGraph::semi_dominators (int r) {
 		//ancestor[i] = 0;
 	}
 
-	int N = preDFSp (r, label2pre, pre2label, parent);
+	int N = preDFSp<Iterator> (r, label2pre, pre2label, parent);
 
 	for (i=N; i>=2; i--) {
 		int w = pre2label[i];
-		int *p, *stop;
-		getInBounds(w,p,stop);
-		for (; p<stop; p++) {
-			int v = label2pre[*p];
+		int nbr;
+		Iterator a = inArcs<Iterator> (w);
+		while (a.next(nbr)) {
+			int v = label2pre[nbr];
 			if (v) {
 				int u;
 				//if (!ancestor[v]) {u=v;}
@@ -47,6 +47,11 @@ int DominatorGraph::semi_dominators (int r) {
 		//ancestor[i] = parent[i];
 	}
 
-	delete [] buffer;
+	mpDelete (buffer);
 	return npdom;
 }
+
+int DominatorGraph::semi_dominators (int r) {
+	if (compressed) return semi_dominators<PackedArcIterator> (r);
+	return semi_dominators<ArcIterator> (r);
+}
@@ -0,0 +1,545 @@
+#include "dgraph_semiext.h"
+#include "rfw_timer.h"
+#include <string.h>
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+/*---------------------------------------------------------
+ | semi-external snca: see dgraph_semiext.h for an overview
+ *--------------------------------------------------------*/
+
+static void semiextFatal (const char *msg, const char *arg = "") {
+	fprintf (stderr, "ERROR: %s%s.\n", msg, arg);
+	exit(-1);
+}
+
+SemiExternalDominators::SemiExternalDominators (const char *_tmpdir, size_t _memcap) {
+	tmpdir = _tmpdir;
+	memcap = _memcap;
+	memused = mempeak = 0;
+	n = 0;
+	m = 0;
+	source = 0;
+	first_out = NULL;
+	ioread = iowritten = 0;
+	iotime = 0.0;
+	nruns = 0;
+	tconvert = tsort = tdfs = tsemi = tnca = 0.0;
+	makeName (arcfile, "arcs");
+	makeName (outfile, "out");
+	makeName (infile, "in");
+}
+
+SemiExternalDominators::~SemiExternalDominators() {
+	if (first_out) release (first_out, (n+2)*sizeof(long long));
+	remove (arcfile);
+	remove (outfile);
+	remove (infile);
+}
+
+void SemiExternalDominators::makeName (char *name, const char *suffix, int k) {
+	if (k<0) snprintf (name, 1024, "%s/semiext.%d.%s", tmpdir, (int)getpid(), suffix);
+	else snprintf (name, 1024, "%s/semiext.%d.%s.%d", tmpdir, (int)getpid(), suffix, k);
+}
+
+
+/*------------------------------------------------------
+ | memory: every allocation is checked against the cap
+ *-----------------------------------------------------*/
+
+void *SemiExternalDominators::alloc (size_t bytes) {
+	if (memused + bytes > memcap) {
+		fprintf (stderr, "ERROR: memory cap of %lu bytes exceeded (%lu in use, %lu requested).\n", 
+		         (unsigned long)memcap, (unsigned long)memused, (unsigned long)bytes);
+		exit(-1);
+	}
+	void *p = malloc (bytes ? bytes : 1);
+	if (!p) semiextFatal ("out of memory");
+	memused += bytes;
+	if (memused > mempeak) mempeak = memused;
+	return p;
+}
+
+void SemiExternalDominators::release (void *p, size_t bytes) {
+	free (p);
+	memused -= bytes;
+}
+
+
+/*------------------------------------------------------
+ | i/o: unbuffered files (buffers are ours, and count
+ | against the cap), with byte and time accounting
+ *-----------------------------------------------------*/
+
+FILE *SemiExternalDominators::openFile (const char *filename, const char *mode) {
+	FILE *file = fopen (filename, mode);
+	if (!file) semiextFatal ("cannot open temporary file ", filename);
+	setvbuf (file, NULL, _IONBF, 0);
+	return file;
+}
+
+size_t SemiExternalDominators::readBlock (FILE *file, void *buffer, size_t bytes) {
+	RFWTimer timer(true);
+	size_t got = fread (buffer, 1, bytes, file);
+	iotime += timer.getTime();
+	ioread += got;
+	return got;
+}
+
+void SemiExternalDominators::writeBlock (FILE *file, const void *buffer, size_t bytes) {
+	RFWTimer timer(true);
+	if (fwrite (buffer, 1, bytes, file) != bytes) semiextFatal ("cannot write temporary file (disk full?)");
+	iotime += timer.getTime();
+	iowritten += bytes;
+}
+
+
+/*---------------------------------------------------------------
+ | reads a graph in dimacs format, streaming the arcs into the
+ | arc file; only the out-degrees are kept (in first_out)
+ *--------------------------------------------------------------*/
+
+void SemiExternalDominators::readDimacs (const char *filename, bool reverse) {
+	RFWTimer timer(true);
+	FILE *input = fopen (filename, "r");
+	if (!input) semiextFatal ("cannot open file ", filename);
+
+	int src, snk;
+	long long declared;
+	if (fscanf (input, "p %d %lld %d %d\n", &n, &declared, &src, &snk)!=4) semiextFatal ("cannot read graph size in ", filename);
+	source = reverse ? snk : src;
+
+	first_out = (long long *)alloc ((n+2)*sizeof(long long));
+	for (int v=n+1; v>=0; v--) first_out[v] = 0;
+
+	size_t bufsize = 1<<16; //records
+	if (declared>=0 && (size_t)declared < bufsize) bufsize = (size_t)declared + 1; //only a hint
+	int *buffer = (int *)alloc (2*bufsize*sizeof(int));
+	FILE *output = openFile (arcfile, "wb");
+
+	size_t k = 0;
+	m = 0;
+	while (1) {
+		int a, b;
+		if (fscanf (input, "a %d %d\n", &a, &b)!=2) { //arc from a to b
+			long long w;
+			if (fscanf (input, "n %d %lld\n", &a, &w)==2) continue; //vertex weight (not needed here)
+			break;
+		}
+		if (reverse) {int t = a; a = b; b = t;}
+		if (a<1 || a>n || b<1 || b>n) semiextFatal ("arc out of range in ", filename);
+		buffer[2*k] = a;
+		buffer[2*k+1] = b;
+		first_out[a]++;
+		m++;
+		if (++k==bufsize) {
+			writeBlock (output, buffer, 2*k*sizeof(int));
+			k = 0;
+		}
+	}
+	if (k) writeBlock (output, buffer, 2*k*sizeof(int));
+	ioread += ftell (input);
+	fclose (input);
+	fclose (output);
+	release (buffer, 2*bufsize*sizeof(int));
+
+	//degrees to offsets: first_out[v] is the index of the first arc out of v
+	long long sum = 0;
+	for (int v=1; v<=n+1; v++) {
+		long long d = first_out[v];
+		first_out[v] = sum;
+		sum += d;
+	}
+	first_out[0] = 0;
+	tconvert = timer.getTime();
+}
+
+
+/*----------------------------------------------------------------
+ | external merge sort of pairs of ints by their first element:
+ | sorted runs as large as the budget allows, then a single k-way 
+ | merge (one buffer per run, plus one for the output)
+ *---------------------------------------------------------------*/
+
+static int comparePairs (const void *a, const void *b) {
+	int x = *(const int *)a;
+	int y = *(const int *)b;
+	return (x<y) ? -1 : (x>y) ? 1 : 0;
+}
+
+void SemiExternalDominators::sortPairs (const char *input, const char *output, size_t budget) {
+	const size_t rsize = 2*sizeof(int); //bytes per record
+	size_t capacity = budget / rsize;
+	if (capacity < 1024) semiextFatal ("memory cap too small for sorting");
+	if (capacity > (size_t)m + 1024) capacity = (size_t)m + 1024; //no need for more
+
+	//create sorted runs (all of capacity records but the last)
+	int *buffer = (int *)alloc (capacity*rsize);
+	FILE *in = openFile (input, "rb");
+	char name[1024];
+	int k = 0;
+	size_t lastrun = 0; //records in the last run
+	while (1) {
+		size_t got = readBlock (in, buffer, capacity*rsize) / rsize;
+		if (!got) break;
+		lastrun = got;
+		qsort (buffer, got, rsize, comparePairs);
+		makeName (name, "run", k++);
+		FILE *run = openFile (name, "wb");
+		writeBlock (run, buffer, got*rsize);
+		fclose (run);
+		if (got<capacity) break;
+	}
+	fclose (in);
+	release (buffer, capacity*rsize);
+	nruns += k;
+
+	if (k<=1) { //already sorted
+		makeName (name, "run", 0);
+		if (k==0) fclose (openFile (output, "wb"));
+		else if (rename (name, output)!=0) semiextFatal ("cannot rename ", name);
+		return;
+	}
+
+	//merge: one buffer per run plus one for the output, none larger than a run
+	size_t overhead = k*(sizeof(FILE *) + sizeof(int *) + 3*sizeof(size_t) + sizeof(int));
+	size_t bsize = (budget > overhead) ? (budget - overhead) / rsize / (k+1) : 0; //records per buffer
+	if (bsize < 16) semiextFatal ("memory cap too small to merge all runs");
+	if (bsize > capacity) bsize = capacity;
+	FILE **runs = (FILE **)alloc (k*sizeof(FILE *));
+	int **buf = (int **)alloc (k*sizeof(int *));
+	size_t *pos = (size_t *)alloc (k*sizeof(size_t));
+	size_t *len = (size_t *)alloc (k*sizeof(size_t));
+	size_t *cap = (size_t *)alloc (k*sizeof(size_t)); //records in buf[r]
+	int *heap = (int *)alloc (k*sizeof(int)); //runs, by current key
+	int *obuf = (int *)alloc (bsize*rsize);
+
+	int h = 0;
+	for (int r=0; r<k; r++) {
+		makeName (name, "run", r);
+		runs[r] = openFile (name, "rb");
+		cap[r] = (r==k-1 && lastrun<bsize) ? lastrun : bsize;
+		buf[r] = (int *)alloc (cap[r]*rsize);
+		len[r] = readBlock (runs[r], buf[r], cap[r]*rsize) / rsize;
+		pos[r] = 0;
+		heap[h++] = r;
+	}
+
+	#define KEY(r) (buf[r][2*pos[r]])
+	//heapify
+	for (int i=h/2-1; i>=0; i--) {
+		int j = i;
+		while (1) {
+			int c = 2*j+1;
+			if (c>=h) break;
+			if (c+1<h && KEY(heap[c+1])<KEY(heap[c])) c++;
+			if (KEY(heap[j])<=KEY(heap[c])) break;
+			int t = heap[j]; heap[j] = heap[c]; heap[c] = t;
+			j = c;
+		}
+	}
+
+	FILE *out = openFile (output, "wb");
+	size_t o = 0;
+	while (h>0) {
+		int r = heap[0];
+		obuf[2*o] = buf[r][2*pos[r]];
+		obuf[2*o+1] = buf[r][2*pos[r]+1];
+		if (++o==bsize) {writeBlock (out, obuf, o*rsize); o = 0;}
+
+		//advance run r, refilling its buffer if needed
+		if (++pos[r]==len[r]) {
+			len[r] = readBlock (runs[r], buf[r], cap[r]*rsize) / rsize;
+			pos[r] = 0;
+			if (!len[r]) heap[0] = heap[--h]; //run exhausted
+		}
+
+		//sift down
+		int j = 0;
+		while (1) {
+			int c = 2*j+1;
+			if (c>=h) break;
+			if (c+1<h && KEY(heap[c+1])<KEY(heap[c])) c++;
+			if (KEY(heap[j])<=KEY(heap[c])) break;
+			int t = heap[j]; heap[j] = heap[c]; heap[c] = t;
+			j = c;
+		}
+	}
+	#undef KEY
+	if (o) writeBlock (out, obuf, o*rsize);
+	fclose (out);
+
+	for (int r=0; r<k; r++) {
+		fclose (runs[r]);
+		release (buf[r], cap[r]*rsize);
+		makeName (name, "run", r);
+		remove (name);
+	}
+	release (obuf, bsize*rsize);
+	release (heap, k*sizeof(int));
+	release (cap, k*sizeof(size_t));
+	release (len, k*sizeof(size_t));
+	release (pos, k*sizeof(size_t));
+	release (buf, k*sizeof(int *));
+	release (runs, k*sizeof(FILE *));
+}
+
+
+/*----------------------------------------------------------------
+ | pre-dfs with parents over the out-sorted arc file; the stack 
+ | keeps, for each vertex on it, the index of its next arc, and 
+ | arcs are read through a direct-mapped cache of disk blocks
+ *---------------------------------------------------------------*/
+
+int SemiExternalDominators::dfs (int r, int *label2pre, int *pre2label, int *parent, size_t budget) {
+	const size_t rsize = 2*sizeof(int);
+	size_t stackbytes = (n+1)*(sizeof(int)+sizeof(long long));
+	if (budget < stackbytes + 4096) semiextFatal ("memory cap too small for the dfs stack");
+	budget -= stackbytes;
+	int *stackv = (int *)alloc ((n+1)*sizeof(int));
+	long long *stacka = (long long *)alloc ((n+1)*sizeof(long long)); //next arc
+
+	//block cache: small blocks, since a dfs jumps all over the file (no more than the file has)
+	size_t bbytes = 4096;
+	size_t nblocks = budget / (bbytes + sizeof(long long));
+	if (nblocks < 1) semiextFatal ("memory cap too small for the dfs cache");
+	size_t fileblocks = ((size_t)m*rsize + bbytes - 1) / bbytes;
+	if (nblocks > fileblocks) nblocks = fileblocks ? fileblocks : 1;
+	size_t brecords = bbytes / rsize;
+	int *cache = (int *)alloc (nblocks*bbytes);
+	long long *tag = (long long *)alloc (nblocks*sizeof(long long));
+	for (size_t b=0; b<nblocks; b++) tag[b] = -1;
+	FILE *arcs = openFile (outfile, "rb");
+
+	for (int v=n; v>=0; v--) label2pre[v] = 0;
+	int next = 1;
+	int sp = 0;
+	label2pre[r] = next;
+	pre2label[next] = r;
+	parent[next++] = 0;
+	stackv[sp] = r;
+	stacka[sp++] = first_out[r];
+
+	while (sp) {
+		int v = stackv[sp-1];
+		long long a = stacka[sp-1];
+		if (a==first_out[v+1]) {sp--; continue;} //done with v
+		stacka[sp-1] = a+1;
+
+		//get the head of arc a
+		long long block = a / (long long)brecords;
+		size_t slot = (size_t)(block % (long long)nblocks);
+		int *data = &cache[slot*(bbytes/sizeof(int))];
+		if (tag[slot]!=block) {
+			fseeko (arcs, (off_t)block * (off_t)bbytes, SEEK_SET);
+			readBlock (arcs, data, bbytes);
+			tag[slot] = block;
+		}
+		int w = data[2*(a - block*(long long)brecords) + 1];
+
+		if (!label2pre[w]) {
+			parent[next] = label2pre[v];
+			pre2label[next] = w;
+			label2pre[w] = next++;
+			stackv[sp] = w;
+			stacka[sp++] = first_out[w];
+		}
+	}
+	fclose (arcs);
+
+	release (tag, nblocks*sizeof(long long));
+	release (cache, nblocks*bbytes);
+	release (stacka, (n+1)*sizeof(long long));
+	release (stackv, (n+1)*sizeof(int));
+	return next-1;
+}
+
+
+/*----------------------------------------------------------------
+ | writes (N+1-pre[w], pre[v]) for every arc (v,w) with v reachable,
+ | sorted by the first field: incoming arcs by decreasing pre[w]
+ *---------------------------------------------------------------*/
+
+void SemiExternalDominators::relabel (int N, int *label2pre, size_t budget) {
+	const size_t rsize = 2*sizeof(int);
+	char tmpname[1024];
+	makeName (tmpname, "inunsorted");
+
+	size_t bsize = (budget/2) / rsize;
+	if (bsize > (1<<16)) bsize = 1<<16;
+	if (bsize > (size_t)m + 1) bsize = (size_t)m + 1; //whole file in one read
+	int *ibuf = (int *)alloc (bsize*rsize);
+	int *obuf = (int *)alloc (bsize*rsize);
+	FILE *in = openFile (arcfile, "rb");
+	FILE *out = openFile (tmpname, "wb");
+	size_t o = 0;
+	while (1) {
+		size_t got = readBlock (in, ibuf, bsize*rsize) / rsize;
+		for (size_t i=0; i<got; i++) {
+			int v = label2pre[ibuf[2*i]];
+			if (!v) continue; //unreachable source
+			obuf[2*o] = N+1-label2pre[ibuf[2*i+1]];
+			obuf[2*o+1] = v;
+			if (++o==bsize) {writeBlock (out, obuf, o*rsize); o = 0;}
+		}
+		if (got<bsize) break;
+	}
+	if (o) writeBlock (out, obuf, o*rsize);
+	fclose (in);
+	fclose (out);
+	release (obuf, bsize*rsize);
+	release (ibuf, bsize*rsize);
+
+	sortPairs (tmpname, infile, memcap-memused);
+	remove (tmpname);
+}
+
+
+/*------------------------------------------------------------
+ | compress used by snca (as rcompress in dgraph.h), with an
+ | explicit stack of n+1 entries instead of recursion: forest
+ | paths can be as long as the dfs tree is deep
+ *-----------------------------------------------------------*/
+
+static void semiextCompress (int v, int *parent, int *label, int c, int *stack) {
+	int top = 0;
+	while (parent[v]>c) { //v is not the last vertex of the path
+		stack[top++] = v;
+		v = parent[v];
+	}
+	while (top) { //back down, as the recursion returns
+		int w = stack[--top];
+		int p = parent[w];
+		if (label[p]<label[w]) label[w] = label[p];
+		parent[w] = parent[p];
+	}
+}
+
+
+/*---------------------------------------------------------------
+ | SEMI-NCA with the arcs on disk (see DominatorGraph::snca)
+ *--------------------------------------------------------------*/
+
+void SemiExternalDominators::snca (int r, int *idom) {
+	memused += (n+1)*sizeof(int); //idom belongs to the caller, but counts
+	if (memused > memcap) semiextFatal ("memory cap too small for the output array");
+	if (memused > mempeak) mempeak = memused;
+
+	RFWTimer timer(true);
+	size_t bytes = (n+1)*sizeof(int);
+	int *pre2label = (int *)alloc (bytes);
+	int *parent    = (int *)alloc (bytes);
+	int *label2pre = idom;
+
+	//sort the arcs by source and run the dfs
+	sortPairs (arcfile, outfile, memcap-memused);
+	tsort += timer.getTime();
+	timer.start();
+	int N = dfs (r, label2pre, pre2label, parent, memcap-memused);
+	tdfs = timer.getTime();
+	release (first_out, (n+2)*sizeof(long long)); //no longer needed
+	first_out = NULL;
+	remove (outfile);
+
+	//incoming arcs by decreasing pre-id of the target
+	timer.start();
+	relabel (N, label2pre, memcap-memused-4*bytes);
+	tsort += timer.getTime();
+
+	/*----------------
+	 | semidominators
+	 *---------------*/
+	timer.start();
+	int *label = (int *)alloc (bytes);
+	int *semi  = (int *)alloc (bytes);
+	int *dom   = (int *)alloc (bytes);
+	int *stack = (int *)alloc (bytes); //for compress
+	for (int i=n; i>=0; i--) label[i] = semi[i] = i;
+
+	const size_t rsize = 2*sizeof(int);
+	size_t bsize = (memcap-memused) / rsize;
+	if (bsize < 16) semiextFatal ("memory cap too small for the arc stream");
+	if (bsize > (1<<16)) bsize = 1<<16;
+	if (bsize > (size_t)m + 1) bsize = (size_t)m + 1;
+	int *buffer = (int *)alloc (bsize*rsize);
+	FILE *in = openFile (infile, "rb");
+	size_t got = readBlock (in, buffer, bsize*rsize) / rsize;
+	size_t pos = 0;
+
+	for (int i=N; i>1; i--) {
+		dom[i] = parent[i];
+		int key = N+1-i;
+		while (got) {
+			if (pos==got) {
+				got = readBlock (in, buffer, bsize*rsize) / rsize;
+				pos = 0;
+				continue;
+			}
+			if (buffer[2*pos]!=key) break; //arcs into i are over
+			int v = buffer[2*pos+1];
+			pos++;
+			int u;
+			if (v<=i) {u=v;} //v is an ancestor of i
+			else {
+				semiextCompress (v, parent, label, i, stack);
+				u = label[v];
+			}
+			if (semi[u]<semi[i]) semi[i] = semi[u];
+		}
+		label[i] = semi[i];
+	}
+	fclose (in);
+	release (buffer, bsize*rsize);
+	release (stack, bytes);
+	tsemi = timer.getTime();
+
+	/*-----------------------------------------------------------
+	 | compute dominators using idom[w]=NCA(I,parent[w],sdom[w])
+	 *----------------------------------------------------------*/
+	timer.start();
+	dom[1] = 1;
+	idom[r] = r;
+	for (int i=2; i<=N; i++) {
+		int j = dom[i];
+		while (j>semi[i]) j = dom[j];
+		dom[i] = j;
+		idom[pre2label[i]] = pre2label[dom[i]];
+	}
+	tnca = timer.getTime();
+
+	release (dom, bytes);
+	release (semi, bytes);
+	release (label, bytes);
+	release (parent, bytes);
+	release (pre2label, bytes);
+	memused -= (n+1)*sizeof(int);
+}
+
+
+void SemiExternalDominators::outputStatistics (FILE *file) {
+	double total = tconvert + tsort + tdfs + tsemi + tnca;
+	fprintf (file, "vertices %d\n", n);
+	fprintf (file, "arcs %lld\n", m);
+	fprintf (file, "source %d\n", source);
+	fprintf (file, "memcap %lu\n", (unsigned long)memcap);
+	fprintf (file, "mempeak %lu\n", (unsigned long)mempeak);
+	fprintf (file, "mempeakv %.2f\n", (double)mempeak/(double)n);
+	fprintf (file, "arcbytes %lld\n", 2*m*(long long)sizeof(int));
+	fprintf (file, "sortruns %d\n", nruns);
+	fprintf (file, "ioread %lld\n", ioread);
+	fprintf (file, "iowritten %lld\n", iowritten);
+	fprintf (file, "iotime %.6f\n", iotime);
+	if (iotime>0) fprintf (file, "iombps %.2f\n", (double)(ioread+iowritten)/iotime/1e6);
+	fprintf (file, "readmbpse %.2f\n", (double)ioread/total/1e6);
+	fprintf (file, "writtenmbpse %.2f\n", (double)iowritten/total/1e6);
+	fprintf (file, "timeconvert %.6f\n", tconvert);
+	fprintf (file, "timesort %.6f\n", tsort);
+	fprintf (file, "timedfs %.6f\n", tdfs);
+	fprintf (file, "timesemi %.6f\n", tsemi);
+	fprintf (file, "timenca %.6f\n", tnca);
+	fprintf (file, "totaltime %.6f\n", total);
+}
@@ -0,0 +1,69 @@
+#ifndef DGRAPH_SEMIEXT_H
+#define DGRAPH_SEMIEXT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------
+ | Semi-external dominators: only O(n) vertex arrays live in memory;
+ | arcs stay in binary files in a temporary directory.
+ | - readDimacs streams the input into an arc file (v,w pairs)
+ | - the arcs are sorted by source (external merge sort) and a dfs
+ |   reads them through a small block cache, using an explicit stack
+ | - the arcs are relabeled with pre-ids and sorted by decreasing 
+ |   pre-id of the target, so that the semidominator phase of snca 
+ |   can read them as one sequential stream (path compression uses
+ |   an explicit stack too)
+ | - the nca phase only needs vertex arrays
+ | All buffers (sort runs, merge buffers, block cache) are sized to 
+ | fit in the memory budget together with the vertex arrays, but no
+ | larger than the data they hold, so mempeak reports real use; the
+ | budget is only checked, never exceeded, by allocations made here.
+ *-------------------------------------------------------------------*/
+
+class SemiExternalDominators {
+	private:
+		int n;           //number of vertices
+		long long m;     //number of arcs
+		int source;
+
+		const char *tmpdir;
+		char arcfile[1024];    //input arcs, (v,w), unsorted
+		char outfile[1024];    //arcs sorted by source
+		char infile[1024];     //(N+1-pre[w], pre[v]) sorted by pre[w] decreasing
+		long long *first_out;  //first_out[v]: index of first arc of v in outfile
+
+		//memory accounting
+		size_t memcap, memused, mempeak;
+		void *alloc (size_t bytes);
+		void release (void *p, size_t bytes);
+
+		//i/o accounting
+		long long ioread, iowritten;
+		double iotime;
+		int nruns;   //sorted runs created by external sorts
+		double tconvert, tsort, tdfs, tsemi, tnca; //seconds per phase
+
+		size_t readBlock (FILE *file, void *buffer, size_t bytes);
+		void writeBlock (FILE *file, const void *buffer, size_t bytes);
+		FILE *openFile (const char *filename, const char *mode);
+		void makeName (char *name, const char *suffix, int k=-1);
+
+		void sortPairs (const char *input, const char *output, size_t budget); //by first int
+		int dfs (int r, int *label2pre, int *pre2label, int *parent, size_t budget);
+		void relabel (int N, int *label2pre, size_t budget);
+
+	public:
+		SemiExternalDominators (const char *_tmpdir, size_t _memcap);
+		~SemiExternalDominators();
+
+		void readDimacs (const char *filename, bool reverse);
+		inline int getNVertices() const {return n;}
+		inline long long getNArcs() const {return m;}
+		inline int getSource() const {return source;}
+
+		void snca (int r, int *idom); //idom must have n+1 entries (counted against the budget)
+		void outputStatistics (FILE *file);
+};
+
+#endif
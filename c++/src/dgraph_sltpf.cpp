@@ -0,0 +1,122 @@
+#include "dgraph.h"
+
+/*--------------------------------------------------------
+ | Simple Lengauer-Tarjan with software prefetching 
+ | (slt-pf): same as slt, but the arc loop of vertex i
+ | overlaps with prefetches for the vertices DG_PFDIST, 
+ | 2*DG_PFDIST, and 3*DG_PFDIST positions ahead (see 
+ | prefetchBounds/prefetchPre/prefetchTargets in dgraph.h)
+ *--------------------------------------------------------*/
+
+template <class Iterator> void DominatorGraph::sltpf (int r, int *idom) {
+	int bsize = n+1;
+	int *buffer    = mpNew<int> (6*bsize);
+	int *pre2label = &buffer[0];
+	int *parent    = &buffer[bsize];
+	int *semi      = &buffer[2*bsize];
+	int *label     = &buffer[3*bsize];
+	int *dom       = &buffer[4*bsize];
+	int *ubucket   = &buffer[5*bsize];
+
+	int *label2pre = idom;          //indexed by label
+
+	resetcounters();
+	DG_PHASE(PH_INIT);
+
+	int i;
+	for (i=n; i>=0; i--) {
+		label[i] = semi[i] = i;
+		ubucket[i] = 0;
+	}
+
+	//pre-dfs
+	DG_PHASE(PH_SEARCH);
+	int N = preDFSp<Iterator> (r, label2pre, pre2label, parent);
+
+	// process the vertices in reverse preorder 
+	DG_PHASE(PH_SEMI);
+
+	//fill the pipeline
+	for (i=N; i>N-3*DG_PFDIST && i>1; i--) prefetchBounds (i, pre2label);
+	for (i=N; i>N-2*DG_PFDIST && i>1; i--) prefetchPre<Iterator> (i, pre2label, label2pre);
+	for (i=N; i>N-DG_PFDIST && i>1; i--) prefetchTargets<Iterator> (i, pre2label, label2pre, parent, label);
+
+	for (i=N; i>1; i--) {
+		/*--------------------- 
+		 | process i-th bucket
+		 *--------------------*/
+		if (ubucket[i]) {
+			DG_PHASE(PH_BUCKET); //only switch phases for nonempty buckets
+			for (int v=ubucket[i]; v; v=ubucket[v]) {
+				rcompress (v, parent, semi, label, i);
+				int u = label[v];
+				incc();
+				dom[v] = (semi[u]<semi[v]) ? u : i;
+			}
+			DG_PHASE(PH_SEMI);
+		}
+
+		prefetchBounds (i-3*DG_PFDIST, pre2label);
+		prefetchPre<Iterator> (i-2*DG_PFDIST, pre2label, label2pre);
+		prefetchTargets<Iterator> (i-DG_PFDIST, pre2label, label2pre, parent, label);
+
+		/*---------------------------------------------
+		 | check incoming arcs, update semi-dominators
+		 *--------------------------------------------*/
+		int nbr;
+		Iterator a = inArcs<Iterator> (pre2label[i]);
+		while (a.next(nbr)) {
+			int v = label2pre[nbr];
+			incc();
+			if (v) {
+				int u; 
+				incc();
+				if (v<=i) {u=v;} //v is an ancestor of i
+				else {
+					rcompress (v, parent, semi, label, i);
+					u = label[v];
+				}
+				incc();
+				if (semi[u]<semi[i]) semi[i] = semi[u];
+			}
+		}
+
+		/*---------------------------
+		 | process candidate semidom
+		 *--------------------------*/
+		int s = semi[i];
+		incc();
+		if (s!=parent[i]) { //if semidominator n not parent: add i to s's bucket
+			ubucket[i] = ubucket[s]; 
+			ubucket[s] = i;
+		} else {
+			dom[i] = s; //semidominator is parent: s is a candidate dominator
+		}
+	}
+
+	/*------------------
+	 | process bucket 1
+	 *-----------------*/
+	DG_PHASE(PH_BUCKET);
+	for (int v=ubucket[1]; v; v=ubucket[v]) dom[v]=1;
+
+	/*---------------
+	 | recover idoms 
+	 *--------------*/
+	DG_PHASE(PH_IDOM);
+	dom[1] = 1;
+	idom[r] = r;
+	for (i=2; i<=N; i++) {
+		incc();
+		if (dom[i]!=semi[i]) dom[i]=dom[dom[i]]; //make relative absolute
+		idom[pre2label[i]] = pre2label[dom[i]];
+	}
+	DG_PHASEEND();
+
+	mpDelete (buffer); //cleanup stuff
+}
+
+void DominatorGraph::sltpf (int r, int *idom) {
+	if (compressed) sltpf<PackedArcIterator> (r, idom);
+	else sltpf<ArcIterator> (r, idom);
+}
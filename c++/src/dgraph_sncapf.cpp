@@ -0,0 +1,92 @@
+#include "dgraph.h"
+
+/*---------------------------------------------------------------
+ | SEMI-NCA with software prefetching (snca-pf): same as snca,
+ | but the semidominator loop runs a three-stage prefetch 
+ | pipeline (see prefetchBounds/prefetchPre/prefetchTargets in
+ | dgraph.h) over the vertices still to be processed, so that
+ | the dependent loads of vertex i-DG_PFDIST, i-2*DG_PFDIST, and 
+ | i-3*DG_PFDIST are in flight while vertex i is processed
+ *--------------------------------------------------------------*/
+
+template <class Iterator> void DominatorGraph::sncapf (int r, int *idom) {
+        int bsize = n+1;
+        int *buffer    = mpNew<int> (5*bsize);
+        int *dom       = &buffer[0*bsize]; //not shared
+        int *pre2label = &buffer[1*bsize];
+        int *parent    = &buffer[2*bsize]; //shared with ancestor
+        int *label     = &buffer[3*bsize];
+        int *semi      = &buffer[4*bsize];
+
+        int *label2pre = idom;          //indexed by label
+
+        resetcounters();
+        DG_PHASE(PH_INIT);
+
+        //initialize semi and label
+        int i;
+        for (i=n; i>=0; i--) label[i] = semi[i] = i;
+
+        DG_PHASE(PH_SEARCH);
+        int N = preDFSp<Iterator> (r, label2pre, pre2label, parent);
+
+        /*----------------
+         | semidominators
+         *---------------*/
+        DG_PHASE(PH_SEMI);
+
+        //fill the pipeline
+        for (i=N; i>N-3*DG_PFDIST && i>1; i--) prefetchBounds (i, pre2label);
+        for (i=N; i>N-2*DG_PFDIST && i>1; i--) prefetchPre<Iterator> (i, pre2label, label2pre);
+        for (i=N; i>N-DG_PFDIST && i>1; i--) prefetchTargets<Iterator> (i, pre2label, label2pre, parent, label);
+
+        for (i=N; i>1; i--) {
+                int nbr;
+                dom[i] = parent[i]; //can't put dom and parent together
+
+                prefetchBounds (i-3*DG_PFDIST, pre2label);
+                prefetchPre<Iterator> (i-2*DG_PFDIST, pre2label, label2pre);
+                prefetchTargets<Iterator> (i-DG_PFDIST, pre2label, label2pre, parent, label);
+
+                //process each incoming arc
+                Iterator a = inArcs<Iterator> (pre2label[i]);
+                while (a.next(nbr)) {
+                        int v = label2pre[nbr];
+                        if (v) {
+                                int u;
+                                incc();
+                                if (v<=i) {u=v;} //v is an ancestor of i
+                                else {
+                                        rcompress (v, parent, label, i);
+                                        u = label[v];
+                                }
+                                incc();
+                                if (semi[u]<semi[i]) semi[i] = semi[u];
+                        }
+                }
+                label[i] = semi[i];
+        }
+
+        /*-----------------------------------------------------------
+         | compute dominators using idom[w]=NCA(I,parent[w],sdom[w])
+         *----------------------------------------------------------*/
+        DG_PHASE(PH_NCA);
+        dom[1] = 1;
+        idom[r] = r;
+        for (i=2; i<=N; i++) {
+                int j = dom[i];
+                while (j>semi[i]) {j=dom[j]; incc();}
+                incc();
+                dom[i] = j;
+                idom[pre2label[i]] = pre2label[dom[i]];
+        }
+        DG_PHASEEND();
+
+        //cleanup stuff
+        mpDelete (buffer);
+}
+
+void DominatorGraph::sncapf (int r, int *idom) {
+        if (compressed) sncapf<PackedArcIterator> (r, idom);
+        else sncapf<ArcIterator> (r, idom);
+}
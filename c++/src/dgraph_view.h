@@ -0,0 +1,712 @@
+#ifndef DGRAPH_VIEW_H
+#define DGRAPH_VIEW_H
+
+#include "dgraph.h"
+#include "dgraph_linkeval.h"
+
+/*--------------------------------------------------------------------
+ | Dominators on graph views: snca, slt, lt, ibfs and idfs (and the
+ | searches they use) as templates over any class that models a view
+ | of a graph, so that a graph held in someone else's arrays needs no
+ | copy. These are the only implementations of the five algorithms:
+ | the members of DominatorGraph run them on a DominatorGraph::ArcsView.
+ | A view has vertices 1..n and provides:
+ |   typedef ... Iterator;               //has bool next(int &w)
+ |   int getNVertices() const;
+ |   Iterator getOutArcs (int v) const;  //out-neighbors of v
+ |   Iterator getInArcs (int v) const;   //in-neighbors of v
+ | Models: DominatorGraph itself, DominatorGraph::ArcsView (one arc
+ | iterator, and the members' own searches), CSRView (external CSR
+ | arrays, one per direction), CallbackView (a function returning the
+ | neighbor list of a vertex) and ReverseView (another view with the
+ | arcs reversed, for postdominators).
+ | Each algorithm also takes a meter, which counts operations and
+ | times phases (see ViewMeter); slt and snca take their link-eval
+ | forest (dgraph_linkeval.h) as well. viewSnca, viewSlt, viewLt,
+ | viewIdfs and viewIbfs with three arguments use the default
+ | forests and no instrumentation.
+ | Outputs are idom[0..n], idom[r] = r and idom[v] = 0 for unreachable
+ | vertices. The searches of plain views keep an explicit stack (one
+ | frame per tree level) and the forests do not recurse either, so
+ | deep graphs need no large stack; scratch arrays come from mpNew,
+ | or for slt and snca from the caller's block (see below).
+ *-------------------------------------------------------------------*/
+
+//iterator over a range of ints (the neighbor lists of the views below)
+class RangeIterator {
+	private:
+		const int *p, *stop;
+
+	public:
+		inline RangeIterator (const int *_p, const int *_stop) {p = _p; stop = _stop;}
+
+		//next neighbor in w; false if there are no more
+		inline bool next (int &w) {
+			if (p==stop) return false;
+			w = *(p++);
+			return true;
+		}
+};
+
+
+/*-------------------------------------------------------------
+ | CSR arrays owned by the caller: the out-neighbors of v are
+ | out_adj[out_first[v]] up to out_adj[out_first[v+1]-1] (and
+ | likewise for in-neighbors); first arrays have n+2 entries
+ *------------------------------------------------------------*/
+
+class CSRView {
+	private:
+		int n;
+		const int *out_first, *out_adj;
+		const int *in_first, *in_adj;
+
+	public:
+		typedef RangeIterator Iterator;
+
+		CSRView (int _n, const int *_out_first, const int *_out_adj, const int *_in_first, const int *_in_adj) {
+			n = _n;
+			out_first = _out_first; out_adj = _out_adj;
+			in_first = _in_first; in_adj = _in_adj;
+		}
+
+		inline int getNVertices() const {return n;}
+		inline Iterator getOutArcs (int v) const {return Iterator (&out_adj[out_first[v]], &out_adj[out_first[v+1]]);}
+		inline Iterator getInArcs (int v) const {return Iterator (&in_adj[in_first[v]], &in_adj[in_first[v+1]]);}
+};
+
+
+/*-------------------------------------------------------------
+ | neighbor lists from the caller's functions: each one points
+ | *list to the neighbors of v (which must stay valid until the
+ | algorithm returns) and returns how many there are
+ *------------------------------------------------------------*/
+
+class CallbackView {
+	public:
+		typedef int (*Neighbors) (void *context, int v, const int **list);
+		typedef RangeIterator Iterator;
+
+	private:
+		int n;
+		Neighbors out, in;
+		void *context;
+
+		inline Iterator getArcs (Neighbors f, int v) const {
+			const int *list = NULL;
+			int k = f (context, v, &list);
+			return Iterator (list, list + k);
+		}
+
+	public:
+		CallbackView (int _n, Neighbors _out, Neighbors _in, void *_context) {
+			n = _n; out = _out; in = _in; context = _context;
+		}
+
+		inline int getNVertices() const {return n;}
+		inline Iterator getOutArcs (int v) const {return getArcs (out, v);}
+		inline Iterator getInArcs (int v) const {return getArcs (in, v);}
+};
+
+
+//the arcs of another view, reversed
+template <class View> class ReverseView {
+	private:
+		const View &g;
+
+	public:
+		typedef typename View::Iterator Iterator;
+
+		ReverseView (const View &_g) : g(_g) {}
+
+		inline int getNVertices() const {return g.getNVertices();}
+		inline Iterator getOutArcs (int v) const {return g.getInArcs (v);}
+		inline Iterator getInArcs (int v) const {return g.getOutArcs (v);}
+};
+
+
+/*-------------------------------------------------------------------
+ | meters: the algorithms count comparisons (incc) and iterations
+ | (inci) in meter.ccount and meter.icount, which only happens with
+ | COUNTOPS, and call meter.phase(p) and meter.phaseEnd() as they go
+ | from one phase (DominatorGraph::Phase) to the next; ViewMeter
+ | ignores the phases, DominatorGraph times them (PHASES)
+ *------------------------------------------------------------------*/
+
+class ViewMeter {
+	public:
+		long long ccount, icount;
+
+		ViewMeter() {ccount = icount = 0;}
+		DG_INLINE void phase (int p) {(void)p;}
+		DG_INLINE void phaseEnd () {}
+};
+
+
+/*---------------------------------------------------------
+ | searches: same numbering as preDFSp, postDFS and preBFSp
+ *--------------------------------------------------------*/
+
+template <class Iterator> struct ViewFrame {
+	int v; //vertex (pre-id in viewPreDFS)
+	Iterator a;
+};
+
+template <class View, class Index> int viewPreDFS (const View &g, int r, Index *label2pre, Index *pre2label, Index *parent) {
+	typedef ViewFrame<typename View::Iterator> Frame;
+	int n = g.getNVertices();
+	Frame *stack = mpNew<Frame> (n+1); //the frames below the current one
+	for (int w=n; w>=0; w--) label2pre[w] = 0; //everybody unvisited
+
+	int next = 1;
+	pre2label[next] = r;
+	label2pre[r] = next;
+	int top = 0;
+	int pre_v = next++; //current frame (kept out of the stack)
+	typename View::Iterator a = g.getOutArcs (r);
+	for (;;) {
+		int nbr;
+		if (a.next(nbr)) {
+			if (!label2pre[nbr]) {
+				parent[next] = pre_v;
+				pre2label[next] = nbr;
+				label2pre[nbr] = next;
+				stack[top].v = pre_v;
+				stack[top++].a = a;
+				pre_v = next++;
+				a = g.getOutArcs (nbr);
+			}
+		} else {
+			if (!top) break;
+			pre_v = stack[--top].v;
+			a = stack[top].a;
+		}
+	}
+	mpDelete (stack);
+	return next - 1;
+}
+
+template <class View> int viewPostDFS (const View &g, int r, int *label2post, int *post2label) {
+	typedef ViewFrame<typename View::Iterator> Frame;
+	int n = g.getNVertices();
+	Frame *stack = mpNew<Frame> (n+1);
+	for (int w=n; w>=0; w--) label2post[w] = 0;
+
+	int next = 1;
+	label2post[r] = -1;
+	int top = 0;
+	int v = r;
+	typename View::Iterator a = g.getOutArcs (r);
+	for (;;) {
+		int nbr;
+		if (a.next(nbr)) {
+			if (!label2post[nbr]) {
+				label2post[nbr] = -1;
+				stack[top].v = v;
+				stack[top++].a = a;
+				v = nbr;
+				a = g.getOutArcs (nbr);
+			}
+		} else {
+			post2label[next] = v;
+			label2post[v] = next++;
+			if (!top) break;
+			v = stack[--top].v;
+			a = stack[top].a;
+		}
+	}
+	mpDelete (stack);
+	return next - 1;
+}
+
+template <class View> int viewPreBFS (const View &g, int r, int *label2pre, int *pre2label, int *parent) {
+	for (int v=g.getNVertices(); v>0; v--) label2pre[v] = 0;
+	parent[1] = 1;
+	label2pre[r] = 1;
+	pre2label[1] = r; //also the queue
+	int first = 1, last = 1;
+	while (first<=last) {
+		int nbr;
+		typename View::Iterator a = g.getOutArcs (pre2label[first]);
+		while (a.next(nbr)) {
+			if (!label2pre[nbr]) {
+				pre2label[++last] = nbr;
+				label2pre[nbr] = last;
+				parent[last] = first;
+			}
+		}
+		first++;
+	}
+	return last;
+}
+
+
+//the members' own searches, for the algorithms the members run
+template <class It, class Index> DG_INLINE int viewPreDFS (const DominatorGraph::ArcsView<It> &g, int r, Index *label2pre, Index *pre2label, Index *parent) {
+	return g.preDFS (r, label2pre, pre2label, parent);
+}
+
+template <class It> DG_INLINE int viewPostDFS (const DominatorGraph::ArcsView<It> &g, int r, int *label2post, int *post2label) {
+	return g.postDFS (r, label2post, post2label);
+}
+
+template <class It> DG_INLINE int viewPreBFS (const DominatorGraph::ArcsView<It> &g, int r, int *label2pre, int *pre2label, int *parent) {
+	return g.preBFS (r, label2pre, pre2label, parent);
+}
+
+
+/*-------------------------------------------------------------------
+ | nearest common ancestor of v1 and v2 in the approximate dominator
+ | tree dom: with post-ids (viewIntersect) or pre-ids
+ *------------------------------------------------------------------*/
+
+DG_INLINE int viewIntersect (int v1, int v2, const int *dom, long long &ccount) {
+	do {
+		incc(); //outer test
+		while (v1<v2) {incc(); v1 = dom[v1];}
+		incc(); //failed above
+		while (v2<v1) {incc(); v2 = dom[v2];}
+		incc(); //failed above
+	} while (v1!=v2);
+	(void)ccount;
+	return v1;
+}
+
+DG_INLINE int viewPreIntersect (int v1, int v2, const int *dom, long long &ccount) {
+	do {
+		incc();
+		while (v1>v2) {incc(); v1 = dom[v1];}
+		incc();
+		while (v2>v1) {incc(); v2 = dom[v2];}
+		incc();
+	} while (v1!=v2);
+	(void)ccount;
+	return v1;
+}
+
+
+/*--------------------------------------------------------------------
+ | Simple Lengauer-Tarjan (slt, and lt with a SizedForest) over the
+ | link-eval forest Forest:
+ | - bucket processed at the beginning of each iteration
+ | - vertex v not inserted in bucket if semi[v]==parent[v]
+ | - packed (low-memory) layout: label[i] takes the place of
+ |   pre2label[i] when i is processed (pre2label is rebuilt from
+ |   label2pre at the end), dom[v] that of ubucket[v] (the next
+ |   vertex in its bucket) and, when the forest does not use it,
+ |   semi[i] that of parent[i]
+ | - the arrays are of the forest's Index type; with a narrower one
+ |   (the compact kernels, dgraph_compact.cpp) label2pre cannot be
+ |   idom, so it takes one more array
+ | - scratch: a caller's block of viewSltScratch(n) bytes for the arrays
+ |   (a batch of graphs then runs without allocating); by default
+ |   they come from mpNew
+ *-------------------------------------------------------------------*/
+
+template <class Forest> int viewSltArrays () {
+	const bool packed = Forest::PACKED;
+	const bool shared = packed && !Forest::USESPARENT; //parent and semi in one array
+	const bool narrow = sizeof(typename Forest::Index) < sizeof(int);
+	return (packed ? (shared ? 3 : 4) : 6) + (narrow ? 1 : 0);
+}
+
+template <class Forest> size_t viewSltScratch (int n) {
+	return (viewSltArrays<Forest>() * (size_t)(n+1) + Forest::words(n)) * sizeof(typename Forest::Index);
+}
+
+template <class Forest, class View, class Meter> void viewSltForest (const View &g, int r, int *idom, Meter &meter, char *scratch = NULL) {
+	typedef typename View::Iterator Iterator;
+	typedef typename Forest::Index Index;
+	long long &ccount = meter.ccount; //incc() counts in the meter
+	const bool packed = Forest::PACKED;
+	const bool shared = packed && !Forest::USESPARENT; //parent and semi in one array
+	const bool narrow = sizeof(Index) < sizeof(int); //label2pre needs its own array
+	int n = g.getNVertices();
+	int bsize = n+1;
+	int arrays = viewSltArrays<Forest>();
+	Index *buffer    = scratch ? (Index *)scratch : mpNew<Index> (arrays*bsize + Forest::words(n));
+	int k = 0; //arrays carved so far
+	Index *pre2label = &buffer[(k++)*bsize];
+	Index *label     = packed ? pre2label : &buffer[(k++)*bsize];
+	Index *parent    = &buffer[(k++)*bsize];
+	Index *semi      = shared ? parent : &buffer[(k++)*bsize];
+	Index *ubucket   = &buffer[(k++)*bsize];
+	Index *dom       = packed ? ubucket : &buffer[(k++)*bsize];
+
+	Index *label2pre = narrow ? &buffer[(k++)*bsize] : (Index *)idom; //indexed by label
+
+	meter.phase (DominatorGraph::PH_INIT);
+
+	int i;
+	for (i=n; i>=0; i--) {
+		if (!packed) label[i] = i;
+		if (!shared) semi[i] = i;
+		ubucket[i] = 0;
+		if (narrow) idom[i] = 0; //unreachable unless found below
+	}
+	Forest forest (ccount, parent, semi, label, &buffer[arrays*bsize], n);
+
+	//pre-dfs
+	meter.phase (DominatorGraph::PH_SEARCH);
+	int N = viewPreDFS (g, r, label2pre, pre2label, parent);
+	if (packed) label[0] = semi[0] = 0; //the forests read slot 0
+
+	// process the vertices in reverse preorder
+	meter.phase (DominatorGraph::PH_SEMI);
+	for (i=N; i>1; i--) {
+		int w = pre2label[i];
+		int p = parent[i];
+		if (packed) label[i] = i;
+		if (shared) semi[i] = i;
+
+		/*---------------------
+		 | process i-th bucket
+		 *--------------------*/
+		if (ubucket[i]) {
+			meter.phase (DominatorGraph::PH_BUCKET); //only switch phases for nonempty buckets
+			for (int v=ubucket[i], next; v; v=next) {
+				next = ubucket[v]; //before dom[v] (it may be the same entry)
+				int u = forest.evalLinked (v, i);
+				incc();
+				dom[v] = (forest.semiOf(u)<semi[v]) ? u : i;
+			}
+			meter.phase (DominatorGraph::PH_SEMI);
+		}
+		//no need to empty the bucket
+
+		/*---------------------------------------------
+		 | check incoming arcs, update semi-dominators
+		 *--------------------------------------------*/
+		int nbr;
+		Iterator a = g.getInArcs (w);
+		while (a.next(nbr)) {
+			int v = label2pre[nbr];
+			incc();
+			if (v) {
+				int su = forest.semiOf (forest.eval (v, i));
+				incc();
+				if (su<semi[i]) semi[i] = su;
+			}
+		}
+
+		/*---------------------------
+		 | process candidate semidom
+		 *--------------------------*/
+		int s = semi[i];
+		incc();
+		if (s!=p) { //if semidominator n not parent: add i to s's bucket
+			ubucket[i] = ubucket[s];
+			ubucket[s] = i;
+		} else {
+			dom[i] = s; //semidominator is parent: s is a candidate dominator
+		}
+
+		forest.link (p, i);
+	}
+
+	/*------------------
+	 | process bucket 1
+	 *-----------------*/
+	meter.phase (DominatorGraph::PH_BUCKET);
+	for (int v=ubucket[1], next; v; v=next) {
+		next = ubucket[v];
+		dom[v] = 1;
+	}
+
+	/*---------------
+	 | recover idoms
+	 *--------------*/
+	meter.phase (DominatorGraph::PH_IDOM);
+	if (packed) {
+		for (int v=n; v>0; v--) {
+			int pv = label2pre[v];
+			if (pv) pre2label[pv] = v;
+		}
+	}
+	dom[1] = 1;
+	idom[r] = r;
+	for (i=2; i<=N; i++) {
+		incc();
+		if (dom[i]!=semi[i]) dom[i]=dom[dom[i]]; //make relative absolute
+		idom[pre2label[i]] = pre2label[dom[i]];
+	}
+	meter.phaseEnd();
+
+	if (!scratch) mpDelete (buffer); //cleanup stuff
+	(void)ccount;
+}
+
+
+/*--------------------------------------------------------------------
+ | SEMI-NCA (snca) over the link-eval forest Forest, in two phases:
+ | 1. computes semidominators as in slt
+ | 2. builds the dominator tree incrementally
+ | Packed (low-memory) layout: label[i] takes the place of
+ | pre2label[i] when i is processed (pre2label is rebuilt from
+ | label2pre at the end) and, when the forest does not use it,
+ | parent is dom itself (dom[i] starts as parent[i] anyway)
+ | Index types and scratch blocks (of viewSncaScratch(n) bytes) as in
+ | viewSltForest.
+ *-------------------------------------------------------------------*/
+
+template <class Forest> int viewSncaArrays () {
+	const bool packed = Forest::PACKED;
+	const bool shared = packed && !Forest::USESPARENT; //parent and dom in one array
+	const bool narrow = sizeof(typename Forest::Index) < sizeof(int);
+	return (packed ? (shared ? 3 : 4) : 5) + (narrow ? 1 : 0);
+}
+
+template <class Forest> size_t viewSncaScratch (int n) {
+	return (viewSncaArrays<Forest>() * (size_t)(n+1) + Forest::words(n)) * sizeof(typename Forest::Index);
+}
+
+template <class Forest, class View, class Meter> void viewSncaForest (const View &g, int r, int *idom, Meter &meter, char *scratch = NULL) {
+	typedef typename View::Iterator Iterator;
+	typedef typename Forest::Index Index;
+	long long &ccount = meter.ccount; //incc() counts in the meter
+	const bool packed = Forest::PACKED;
+	const bool shared = packed && !Forest::USESPARENT; //parent and dom in one array
+	const bool narrow = sizeof(Index) < sizeof(int); //label2pre needs its own array
+	int n = g.getNVertices();
+	int bsize = n+1;
+	int arrays = viewSncaArrays<Forest>();
+	Index *buffer    = scratch ? (Index *)scratch : mpNew<Index> (arrays*bsize + Forest::words(n));
+	int k = 0; //arrays carved so far
+	Index *dom       = &buffer[(k++)*bsize];
+	Index *pre2label = &buffer[(k++)*bsize];
+	Index *parent    = shared ? dom : &buffer[(k++)*bsize]; //shared with ancestor (simple forests)
+	Index *label     = packed ? pre2label : &buffer[(k++)*bsize];
+	Index *semi      = &buffer[(k++)*bsize];
+
+	Index *label2pre = narrow ? &buffer[(k++)*bsize] : (Index *)idom; //indexed by label
+
+	meter.phase (DominatorGraph::PH_INIT);
+
+	//initialize semi and label
+	int i;
+	for (i=n; i>=0; i--) {
+		if (!packed) label[i] = i;
+		semi[i] = i;
+		if (narrow) idom[i] = 0; //unreachable unless found below
+	}
+	Forest forest (ccount, parent, semi, label, &buffer[arrays*bsize], n);
+
+	meter.phase (DominatorGraph::PH_SEARCH);
+	int N = viewPreDFS (g, r, label2pre, pre2label, parent);
+	if (packed) label[0] = 0; //the forests read slot 0
+
+	/*----------------
+	 | semidominators
+	 *---------------*/
+	meter.phase (DominatorGraph::PH_SEMI);
+	for (i=N; i>1; i--) {
+		int nbr;
+		int w = pre2label[i];
+		int p = parent[i];
+		if (packed) label[i] = i;
+		dom[i] = p; //dom and parent only share with a sized forest
+
+		//process each incoming arc
+		Iterator a = g.getInArcs (w);
+		while (a.next(nbr)) {
+			int v = label2pre[nbr];
+			if (v) {
+				int su = forest.semiOf (forest.eval (v, i));
+				incc();
+				if (su<semi[i]) semi[i] = su;
+			}
+		}
+		forest.link (p, i);
+	}
+
+	/*-----------------------------------------------------------
+	 | compute dominators using idom[w]=NCA(I,parent[w],sdom[w])
+	 *----------------------------------------------------------*/
+	meter.phase (DominatorGraph::PH_NCA);
+	if (packed) {
+		for (int v=n; v>0; v--) {
+			int pv = label2pre[v];
+			if (pv) pre2label[pv] = v;
+		}
+	}
+	dom[1] = 1;
+	idom[r] = r;
+	for (i=2; i<=N; i++) {
+		int j = dom[i];
+		while (j>semi[i]) {j=dom[j]; incc();}
+		incc();
+		dom[i] = j;
+		idom[pre2label[i]] = pre2label[dom[i]];
+	}
+	meter.phaseEnd();
+
+	//cleanup stuff
+	if (!scratch) mpDelete (buffer);
+	(void)ccount;
+}
+
+
+/*--------------------------------------
+ | iterative dominators algorithm (idfs)
+ | - dominators initalized with zero
+ | - vertices visited in reverse post-order
+ *--------------------------------------*/
+
+template <class View, class Meter> void viewIdfs (const View &g, int r, int *idom, Meter &meter) {
+	typedef typename View::Iterator Iterator;
+	long long &ccount = meter.ccount, &icount = meter.icount; //incc() and inci() count in the meter
+	int n = g.getNVertices();
+	int bsize = n+1;
+	int *buffer = mpNew<int> (2*bsize);
+	int *post2label = &buffer[0]; //post-dfs ids to original label
+	int *dom = &buffer[bsize];    //dominators (indexed by post-ids)
+	int *label2post = idom;       //idom will not be used until later
+
+	meter.phase (DominatorGraph::PH_SEARCH);
+	int N = viewPostDFS (g, r, label2post, post2label); //get post-ids
+
+	meter.phase (DominatorGraph::PH_INIT);
+	for (int v=n; v>=0; v--) dom[v] = 0;
+	dom[N] = N;
+
+	/*-----------
+	 | main loop
+	 *----------*/
+	meter.phase (DominatorGraph::PH_ITER);
+	bool changed;
+	do {
+		inci(); //increment number of iterations (operation count)
+		changed = false;
+
+		for (int i=N-1; i>0; i--) { //reverse post-order
+			int new_idom = 0; //using dom[i] is not faster
+
+			/*----------------------------------------------------
+			 | for each incoming arc (v,w), compute nca between v
+			 | and the current candidate dominator of w
+			 *---------------------------------------------------*/
+			int nbr;
+			Iterator a = g.getInArcs (post2label[i]);
+			while (a.next(nbr)) {
+				int v = label2post[nbr]; //v is the source of the arc
+				incc();
+				if (dom[v]) {           //find nca between current dom and v
+					new_idom = (new_idom ? viewIntersect (v, new_idom, dom, ccount) : v);
+					incc();
+				}
+			}
+
+			//if new dominator found, update dom and mark as changed
+			incc();
+			if (new_idom > dom[i]) {
+				dom[i] = new_idom;
+				changed = true;
+			}
+		}
+	} while (changed);
+
+	/*-----------------------------------------------------------
+	 | restore idoms: unreachable nodes are already zero because
+	 | array is shared with label2post
+	 *----------------------------------------------------------*/
+	meter.phase (DominatorGraph::PH_IDOM);
+	idom[r] = r;
+	for (int i=N-1; i>0; i--) idom[post2label[i]] = post2label[dom[i]];
+	meter.phaseEnd();
+
+	mpDelete (buffer);
+	(void)ccount; (void)icount;
+}
+
+
+/*-------------------------------------------------
+ | iterative dominators algorithm (ibfs)
+ | - dominators initialized with parent in bfs
+ | - vertices visited in direct pre-order
+ *------------------------------------------------*/
+
+template <class View, class Meter> void viewIbfs (const View &g, int r, int *idom, Meter &meter) {
+	typedef typename View::Iterator Iterator;
+	long long &ccount = meter.ccount, &icount = meter.icount; //incc() and inci() count in the meter
+	int bsize = g.getNVertices()+1;
+	int *buffer = mpNew<int> (2*bsize);
+	int *pre2label = &buffer[0];
+	int *dom       = &buffer[bsize];
+	int *label2pre = idom;          //indexed by label
+
+	//find pre-ids, initialize dom with parents in BFS tree
+	meter.phase (DominatorGraph::PH_SEARCH);
+	int N = viewPreBFS (g, r, label2pre, pre2label, dom);
+
+	meter.phase (DominatorGraph::PH_ITER);
+	bool changed = true;
+	while (changed) {
+		inci(); //increment iteration counter
+		changed = false;
+
+		// process vertices in preorder
+		for (int i=2; i<=N; i++) {
+			int new_idom = dom[i];
+
+			/*----------------------------------------------------
+			 | for each incoming arc (v,w), compute nca between v
+			 | and the current candidate dominator of v
+			 *---------------------------------------------------*/
+			int nbr;
+			Iterator a = g.getInArcs (pre2label[i]);
+			while (a.next(nbr)) {
+				int v = label2pre[nbr];
+				incc();
+				if (v) new_idom = viewPreIntersect (v, new_idom, dom, ccount);
+			}
+
+			//if new dominator found, update dom and mark as changed
+			incc();
+			if (new_idom!=dom[i]) {
+				dom[i] = new_idom;
+				changed = true;
+			}
+		}
+	}
+
+	//get dominators
+	meter.phase (DominatorGraph::PH_IDOM);
+	for (int i=N; i>0; i--) idom[pre2label[i]] = pre2label[dom[i]];
+	meter.phaseEnd();
+
+	mpDelete (buffer);
+	(void)ccount; (void)icount;
+}
+
+
+/*------------------------------------------------------------
+ | the algorithms with their default forests (full compression;
+ | lt links by size) and no instrumentation
+ *-----------------------------------------------------------*/
+
+template <class View> void viewSnca (const View &g, int r, int *idom) {
+	ViewMeter meter;
+	viewSncaForest<SimpleForest<PathCompress, true> > (g, r, idom, meter);
+}
+
+template <class View> void viewSlt (const View &g, int r, int *idom) {
+	ViewMeter meter;
+	viewSltForest<SimpleForest<PathCompress, false> > (g, r, idom, meter);
+}
+
+template <class View> void viewLt (const View &g, int r, int *idom) {
+	ViewMeter meter;
+	viewSltForest<SizedForest<PathCompress> > (g, r, idom, meter);
+}
+
+template <class View> void viewIdfs (const View &g, int r, int *idom) {
+	ViewMeter meter;
+	viewIdfs (g, r, idom, meter);
+}
+
+template <class View> void viewIbfs (const View &g, int r, int *idom) {
+	ViewMeter meter;
+	viewIbfs (g, r, idom, meter);
+}
+
+#endif
@@ -2,41 +2,92 @@
    dominators algorithms:
    - Iterative algorithm
    - Lengauer-Tarjan 
-   - SDOM-NCA */
+   - SDOM-NCA
+   - NCA in topological order (acyclic graphs) */
 
 #include "dgraph.h"
+#include "dgraph_view.h"
 #include "rfw_timer.h"
+#include "perf_counters.h"
+#include "bench_stats.h"
+#include "dgraph_semiext.h"
+#include "mem_policy.h"
+#include "series_loader.h"
+#include "idom_writer.h"
+#include "series_pipeline.h"
+#include "dom_server.h"
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 int MINTIME = 1;
+int WARMUP = 1;  //untimed runs before sampling
+int SAMPLES = 0; //number of timed samples (0: as many as fit in MINTIME)
+int INNER = 0;   //runs per sample for single graphs (0: automatic)
+FILE *JSONFILE = NULL; //append one JSON object per invocation
+FILE *CSVFILE = NULL;  //append one CSV row per invocation
+const char *MODELFILE = "dom.model"; //cost model used by "auto" (written by -calibrate)
+bool PERF = false; //read hardware performance counters around measured runs?
+PerfCounters PERFCOUNTERS; //opened by main before any parallel region, so that OpenMP workers count too
+int MEMCAP = 64;  //memory budget (in MB) for -semiext
+const char *TMPDIR = "."; //directory for the temporary files of -semiext
+bool COMPRESS = false; //use the compressed (varint) adjacency lists?
+bool COMPACT = true;   //in series runs of snca and slt, use the 16-bit kernels on graphs that fit?
+bool LOWMEM = false;   //run slt, lt and snca (and their variants) with the packed scratch layouts?
+SeriesLoader LOADER; //reads series (its timings are reported apart from the algorithms')
+IdomWriter WRITER;   //writes -idomfile (text, bin32, bin64, or csr)
+bool TREE = false;   //build (and report) the dominator tree after single-graph runs?
+int RETAINED = -1;   //if nonnegative, report retained sizes and this many top retainers
+int PIPELINE = 0;    //if positive, run series through a pipeline with queues of this depth
+int READERS = 1;     //reader threads of the pipeline
+int WORKERS = 1;     //compute threads of the pipeline (or the server)
+const char *SERVERMETHOD = "snca"; //used by the server when a request names no method
 
 /*----------------------------------------------------------------
- | define methods and method names: make sure they are consistent
+ | methods: the auxiliary searches, DominatorGraph's dominator
+ | methods (same order, see DominatorGraph::Method), and auto
  *---------------------------------------------------------------*/
 typedef enum {
         BFS, 
         DFS, 
         SDOM, 
+        BFSDO,
         IBFS, IDFS, 
         LT,
         SLT,
         SNCA,
+        DAG,
+        SNCAPF,
+        SLTPF,
+        IBFSDO,
+        BITSET,
+        SLTHALVE, SLTSPLIT, //link-eval policies (see dgraph_linkeval.h)
+        LTHALVE, LTSPLIT,
+        SNCAHALVE, SNCASPLIT,
+        SNCASIZED, SNCASIZEDHALVE, SNCASIZEDSPLIT,
+        AUTO,
         METHODS
 } Method;
 
-const char *mnames[METHODS]= {
-        "bfs", 
-        "dfs", 
-        "sdom", 
-        "ibfs", "idfs", 
-        "lt",
-        "slt",
-        "snca", 
-};
+static_assert (AUTO-IBFS==DominatorGraph::DM_METHODS, "dom's methods out of step with DominatorGraph::Method");
+
+//code of a dominator method (IBFS to SNCASIZEDSPLIT) in DominatorGraph
+inline int graphMethod (Method m) {return (int)m - (int)IBFS;}
+
+const char *mname (int m) {
+        static const char *auxnames[IBFS] = {"bfs", "dfs", "sdom", "bfs-do"};
+        if (m<IBFS) return auxnames[m];
+        if (m==AUTO) return "auto";
+        return DominatorGraph::getMethodName (m-IBFS);
+}
 
 
 
@@ -49,6 +100,14 @@ void fatal (const char *msg) {
         exit(-1);
 }
 
+int getNThreads () {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+}
+
 void printBasics (FILE *file) {
         fprintf (file, "version 04112401\n");
 #ifdef COUNTOPS
@@ -56,38 +115,155 @@ void printBasics (FILE *file) {
 #else
         fprintf (file, "counting 0\n");
 #endif
+#ifdef PHASES
+        fprintf (file, "phases 1\n");
+#else
+        fprintf (file, "phases 0\n");
+#endif
+        fprintf (file, "threads %d\n", getNThreads());
+        fprintf (file, "bitsetisa %s\n", DominatorGraph::getBitsetISA());
+        fprintf (file, "lowmem %d\n", (int)LOWMEM);
 }
 
 
 void printUsage(const char *command) {
-        fprintf(stderr, "Usage: %s <input file> <method> [-reverse] [-simplify] [mintime]\n", command);
+        fprintf(stderr, "Usage: %s <input file> <method> [-reverse] [-simplify] [-mintime <t>] [-model <file>] [-perf]\n", command);
+        fprintf(stderr, "       [-warmup <k>] [-samples <k>] [-inner <k>] [-json <file>] [-csv <file>]\n");
+        fprintf(stderr, "       [-pages small|thp|huge] [-numa local|interleave|bind:<node>] [-compress] [-no-compact] [-lowmem]\n");
+        fprintf(stderr, "       [-threads <k>] [-cache <dir> | -no-cache] [-idomfile <file> [-idomformat text|bin32|bin64|csr]]\n");
+        fprintf(stderr, "       [-tree] [-retained <k>] [-pipeline <depth> [-readers <k>] [-workers <k>]]\n");
+        fprintf(stderr, "       %s <input file> -check [-reverse] [-simplify] [-lowmem]\n", command);
+        fprintf(stderr, "       %s <series> -calibrate [-reverse] [-simplify] [-model <file>]\n", command);
+        fprintf(stderr, "       %s <socket> -server [-workers <k>] [-method <method>]\n", command);
+        fprintf(stderr, "       %s <input file> -semiext [-reverse] [-memcap <MB>] [-tmpdir <dir>] [-idomfile <file>]\n", command);
         fprintf(stderr, "Methods: ");
         for (int i=0; i<METHODS; i++) {
-                fprintf (stderr, " %s", mnames[i]);
+                fprintf (stderr, " %s", mname (i));
         }
         fprintf (stderr, "\n\n");
         exit(-1);
 }
 
+/*------------------------------------------------------------------
+ | cost model for automatic method selection: the predicted running
+ | time (in microseconds) of method m on a graph is the dot product
+ | of model[m] with a few cheap features of the graph
+ *-----------------------------------------------------------------*/
+
+const int NFEATURES = 4;
+const char *fnames[NFEATURES] = {"const", "vertices", "arcs", "backarcs"};
+double model[METHODS][NFEATURES];
+bool modeled[METHODS];    //is there a calibrated model for this method?
+bool model_loaded = false;
+
+inline bool isCandidate (Method m) {
+        return (m==IBFS || m==IDFS || m==LT || m==SLT || m==SNCA || m==DAG);
+}
+
+inline void getFeatures (DominatorGraph *g, int r, double *f) {
+        f[0] = 1.0;
+        f[1] = (double)g->getNVertices();
+        f[2] = (double)g->getNArcs();
+        f[3] = (double)g->getBackArcs(r); //cached after the first call
+}
+
+inline double predict (Method m, double *f) {
+        double t = 0.0;
+        for (int k=0; k<NFEATURES; k++) t += model[m][k] * f[k];
+        return t;
+}
+
+
+/*-------------------------------------------------------------------
+ | choose a method for g: use the calibrated model if there is one, 
+ | simple rules otherwise (dag on acyclic graphs, ibfs on small ones 
+ | with few loops, lt on graphs with more back arcs than vertices,
+ | snca otherwise)
+ *------------------------------------------------------------------*/
+
+Method selectMethod (DominatorGraph *g, int r) {
+        double f[NFEATURES];
+        getFeatures (g, r, f);
+        int n = g->getNVertices();
+        int back = (int)f[3];
+
+        if (model_loaded) {
+                Method best = METHODS;
+                double besttime = 0.0;
+                for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
+                        if (!isCandidate(m) || !modeled[m]) continue;
+                        if (m==DAG && back) continue; //dag would fall back to lt
+                        double t = predict (m, f);
+                        if (best==METHODS || t<besttime) {best = m; besttime = t;}
+                }
+                if (best!=METHODS) return best;
+        }
+
+        if (!back) return DAG;
+        if (n<=1024 && 16*back<=n) return IBFS;
+        if (back>n) return LT;
+        return SNCA;
+}
+
+
+/*--------------------------------------------------------
+ | read/write the cost model; a model file has one line 
+ | per method: name followed by NFEATURES coefficients
+ *-------------------------------------------------------*/
+
+bool loadModel (const char *filename) {
+        FILE *input = fopen (filename, "r");
+        if (!input) return false;
+
+        char name[256];
+        double c[NFEATURES];
+        int count = 0;
+        while (fscanf (input, "%255s %lf %lf %lf %lf", name, &c[0], &c[1], &c[2], &c[3])==NFEATURES+1) {
+                for (int i=0; i<METHODS; i++) {
+                        if (strcmp(name, mname (i))!=0 || !isCandidate((Method)i)) continue;
+                        for (int k=0; k<NFEATURES; k++) model[i][k] = c[k];
+                        modeled[i] = true;
+                        count++;
+                }
+        }
+        fclose (input);
+        model_loaded = (count>0);
+        return model_loaded;
+}
+
+void saveModel (const char *filename) {
+        FILE *output = fopen (filename, "w");
+        if (!output) {
+                fprintf (stderr, "Error opening file \"%s\".\n", filename);
+                exit(-1);
+        }
+        for (int i=0; i<METHODS; i++) {
+                if (!modeled[i]) continue;
+                fprintf (output, "%s", mname (i));
+                for (int k=0; k<NFEATURES; k++) fprintf (output, " %.10g", model[i][k]);
+                fprintf (output, "\n");
+        }
+        fclose (output);
+}
+
+
 /*-----------------------
  | run an algorithm once
  *----------------------*/
 
 inline void run (Method method, DominatorGraph *g, int r, int *idom) {
+        g->setLowMemory (LOWMEM);
         switch (method) {
-                //main methods
-                case IBFS: g->ibfs (r, idom); break;
-                case IDFS: g->idfs (r, idom); break;
-                case SLT:  g->slt  (r, idom); break;
-                case LT:   g->lt   (r, idom); break;
-                case SNCA: g->snca (r, idom); break;
+                case AUTO: run (selectMethod (g, r), g, r, idom); break;
 
                 //auxiliary functions
                 case DFS:  g->run_dfs(r); break;
                 case BFS:  g->run_bfs(r); break;
+                case BFSDO: g->run_bfsdo(r); break;
                 case SDOM: g->semi_dominators(r); break;
-        
-                default: break;
+
+                //dominator methods
+                default: g->runMethod (graphMethod (method), r, idom); break;
         }
 }
 
@@ -108,6 +284,57 @@ inline bool compare (int n, int *a, int *b, bool verbose) {
 }
 
 
+/*------------------------------------------------------------------
+ | graph views (dgraph_view.h) for check: g's arcs copied into CSR
+ | arrays, seen directly and through callbacks
+ *-----------------------------------------------------------------*/
+
+struct CheckCSR {
+        int *first[2], *adj[2]; //out, in
+};
+
+static void buildCheckCSR (DominatorGraph *g, CheckCSR &csr) {
+        int n = g->getNVertices();
+        int m = g->getNArcs();
+        for (int d=0; d<2; d++) {
+                csr.first[d] = new int [n+2];
+                csr.adj[d] = new int [m+1];
+                int k = 0, nbr;
+                csr.first[d][0] = 0;
+                for (int v=1; v<=n; v++) {
+                        csr.first[d][v] = k;
+                        AnyArcIterator a = d ? g->getInArcs (v) : g->getOutArcs (v);
+                        while (a.next(nbr)) csr.adj[d][k++] = nbr;
+                }
+                csr.first[d][n+1] = k;
+        }
+}
+
+static int checkNeighbors (void *context, int v, const int **list, int d) {
+        CheckCSR *csr = (CheckCSR *)context;
+        *list = &csr->adj[d][csr->first[d][v]];
+        return csr->first[d][v+1] - csr->first[d][v];
+}
+static int checkOut (void *context, int v, const int **list) {return checkNeighbors (context, v, list, 0);}
+static int checkIn (void *context, int v, const int **list) {return checkNeighbors (context, v, list, 1);}
+
+static const int VIEWCHECKS = 7;
+
+static const char *runViewCheck (int k, DominatorGraph *g, CheckCSR &csr, int r, int *idom) {
+        int n = g->getNVertices();
+        CSRView view (n, csr.first[0], csr.adj[0], csr.first[1], csr.adj[1]);
+        switch (k) {
+                case 0: viewIbfs (view, r, idom); return "ibfs (csr view)";
+                case 1: viewIdfs (view, r, idom); return "idfs (csr view)";
+                case 2: viewLt (view, r, idom); return "lt (csr view)";
+                case 3: viewSlt (view, r, idom); return "slt (csr view)";
+                case 4: viewSnca (view, r, idom); return "snca (csr view)";
+                case 5: viewSnca (*g, r, idom); return "snca (graph as a view)";
+                default: viewSnca (CallbackView (n, checkOut, checkIn, &csr), r, idom); return "snca (callback view)";
+        }
+}
+
+
 /*-------------------------------------------------------
  | checks whether all algorithms produce the same result
  *------------------------------------------------------*/
@@ -122,12 +349,12 @@ inline bool check (DominatorGraph *g, int r, bool verbose = false) {
         for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
                 count ++;
                 if (m==IBFS) {
-                        if (verbose) fprintf (stderr, "Running reference method (%s)... ", mnames[m]);
+                        if (verbose) fprintf (stderr, "Running reference method (%s)... ", mname (m));
                         run (IDFS, g, r, ref);
                         if (verbose) fprintf (stderr, "done.\n");
                         continue;
                 } else {
-                        if (verbose) fprintf (stderr, "Checking %s... ", mnames[m]);
+                        if (verbose) fprintf (stderr, "Checking %s... ", mname (m));
                         for (int i=1; i<=n; i++) idom[i] = n+(int)m+i; //makes sure idoms have weird values
                         run (m, g, r, idom);
                         bool valid = compare (n, ref, idom, verbose);
@@ -139,6 +366,44 @@ inline bool check (DominatorGraph *g, int r, bool verbose = false) {
                 }
         }
 
+        //16-bit kernels (used by series runs of snca and slt)
+        if (g->fitsCompact()) {
+                char *scratch = new char [DominatorGraph::getCompactScratch (n)];
+                for (int k=DominatorGraph::COMPACT_SNCA; k<=DominatorGraph::COMPACT_SLT; k++) {
+                        count++;
+                        if (verbose) fprintf (stderr, "Checking %s (16-bit)... ", k==DominatorGraph::COMPACT_SLT ? "slt" : "snca");
+                        for (int i=1; i<=n; i++) idom[i] = 2*n+k+i;
+                        g->compact ((DominatorGraph::CompactKernel)k, r, idom, scratch);
+                        bool valid = compare (n, ref, idom, verbose);
+                        if (verbose) {
+                                if (valid) fprintf (stderr, "passed.\n");
+                                else fprintf (stderr, "FAILED.\n");
+                        }
+                        passed = passed && valid;
+                }
+                delete [] scratch;
+        }
+
+        //the templates of dgraph_view.h
+        CheckCSR csr;
+        buildCheckCSR (g, csr);
+        for (int k=0; k<VIEWCHECKS; k++) {
+                count++;
+                for (int i=1; i<=n; i++) idom[i] = 3*n+k+i;
+                const char *name = runViewCheck (k, g, csr, r, idom);
+                if (verbose) fprintf (stderr, "Checking %s... ", name);
+                bool valid = compare (n, ref, idom, verbose);
+                if (verbose) {
+                        if (valid) fprintf (stderr, "passed.\n");
+                        else fprintf (stderr, "FAILED.\n");
+                }
+                passed = passed && valid;
+        }
+        for (int d=0; d<2; d++) {
+                delete [] csr.first[d];
+                delete [] csr.adj[d];
+        }
+
         delete [] ref;
         delete [] idom;
 
@@ -156,7 +421,7 @@ Method getMethod (const char *name) {
         Method method = METHODS; //dummy initialization, or else compiler complains
         int i;
         for (i=0; i<METHODS; i++) { //check if there is a match
-                if (strcmp(name, mnames[i])==0) {method = (Method)i; break;}
+                if (strcmp(name, mname (i))==0) {method = (Method)i; break;}
         } 
         return method;
 }
@@ -180,7 +445,7 @@ void printList (const char *listname, int *marked, bool reverse, bool simplify)
         char buffer[1024];
         while (fscanf(input, "%s", buffer)==1) {
                 graph.destroy();
-                graph.readDimacs(buffer,reverse, simplify);
+                graph.readDimacs(buffer,reverse, simplify); //on errors the graph stays empty (no source)
                 if (graph.getSource()!=0) {
                         if (marked[count]>2) fprintf (stdout, "%d %s\n", marked[count], buffer);
                         count++;
@@ -189,43 +454,17 @@ void printList (const char *listname, int *marked, bool reverse, bool simplify)
         fclose(input);
 }
 
-/*----------------------------------------------------------------------------------
- | If glist is not NULL: read all graphs in list name and initialize glist with
- | pointers to the valid ones (graphs will be reversed or simplified if necessary).
- |
- | If glist is NULL: reads all graphs in the list, returns the number of valid 
- | ones.
- |
- | In both cases, a graph will be considered valid iff it has a source (after
- | being reversed, if reverse is true).
- *---------------------------------------------------------------------------------*/
+/*--------------------------------------------------------
+ | reads a graph, compressing its adjacency lists if asked
+ *-------------------------------------------------------*/
 
-int readList (const char *listname, DominatorGraph *glist, bool reverse, bool simplify) {
-        int count = 0, ignored = 0;
-        FILE *input = fopen (listname, "r");
-        if (!input) {
-                fprintf (stderr, "Error opening file \"%s\".\n", listname);
+void loadGraph (DominatorGraph &g, const char *filename, bool reverse, bool simplify) {
+        const char *error = g.readDimacs (filename, reverse, simplify); //WARNING: MAKE SURE REVERSE IS INTERPRETED CORRECTLY
+        if (error) {
+                fprintf (stderr, "ERROR: %s (%s).\n", error, filename);
                 exit(-1);
         }
-        
-        char buffer[1024];
-        DominatorGraph graph;
-        while (fscanf (input, "%s", buffer)==1) {
-                //fprintf (stderr, "<%s>\n", buffer);
-                if (glist) {
-                        glist[count].destroy();
-                        glist[count].readDimacs(buffer,reverse, simplify);
-                        if (glist[count].getSource()!=0) count++;
-                        else ignored ++;
-                } else {
-                        graph.destroy();
-                        graph.readDimacs(buffer,reverse,simplify);
-                        if (graph.getSource()!=0) count++;
-                        else ignored ++;
-                }
-        }
-        fclose (input);
-        return count;
+        if (COMPRESS) g.compressArcs();
 }
 
 
@@ -237,14 +476,13 @@ int readList (const char *listname, DominatorGraph *glist, bool reverse, bool si
  *----------------------------------------------------------------*/
 
 DominatorGraph *createGraphList (const char *listname, bool reverse, int &count, int &maxn, bool simplify) {
-        //just count number of vertices
-        count = readList (listname, NULL, reverse, simplify);
-        fprintf (stderr, "Reading %d graphs... ", count);
-        
-        //actually build graphs and put them in the list
-        DominatorGraph *glist = new DominatorGraph [count+1];
-        readList (listname, glist, reverse, simplify);
-        fprintf (stderr, "done.\n");
+        //a single pass over the files; graphs without a source are dropped
+        fprintf (stderr, "Reading graphs... ");
+        DominatorGraph *glist = LOADER.load (listname, reverse, simplify, COMPRESS, count);
+        fprintf (stderr, "%d graphs (%d ignored) in %.3f seconds.\n", count, LOADER.getNIgnored(), LOADER.getLoadTime());
+        if (LOADER.getCacheHits() + LOADER.getCacheMisses() > 0) {
+                fprintf (stderr, "Cache: %d hits, %d misses.\n", LOADER.getCacheHits(), LOADER.getCacheMisses());
+        }
         
         maxn = 0;
         for (int g=0; g<count; g++) {
@@ -284,28 +522,387 @@ void checkSeries(const char *listname, bool reverse, bool simplify) {
 }
 
 
-/*-------------------------------------------------------
- | run a particular method on all graphs in a given list
- *------------------------------------------------------*/
+/*------------------------------------------------------
+ | solves the k x k linear system A x = b (A and b are 
+ | destroyed); returns false if A is singular
+ *-----------------------------------------------------*/
+
+bool solveLinear (int k, double *A, double *b, double *x) {
+        for (int c=0; c<k; c++) {
+                int p = c; //partial pivoting
+                for (int i=c+1; i<k; i++) {
+                        if (fabs(A[i*k+c]) > fabs(A[p*k+c])) p = i;
+                }
+                if (fabs(A[p*k+c]) < 1e-300) return false;
+                if (p!=c) {
+                        for (int j=0; j<k; j++) {double t = A[c*k+j]; A[c*k+j] = A[p*k+j]; A[p*k+j] = t;}
+                        double t = b[c]; b[c] = b[p]; b[p] = t;
+                }
+                for (int i=c+1; i<k; i++) {
+                        double f = A[i*k+c] / A[c*k+c];
+                        for (int j=c; j<k; j++) A[i*k+j] -= f * A[c*k+j];
+                        b[i] -= f * b[c];
+                }
+        }
+        for (int i=k-1; i>=0; i--) {
+                double s = b[i];
+                for (int j=i+1; j<k; j++) s -= A[i*k+j] * x[j];
+                x[i] = s / A[i*k+i];
+        }
+        return true;
+}
+
+
+/*------------------------------------------------------------------
+ | average time (in microseconds) of one run of a method on a graph
+ *-----------------------------------------------------------------*/
+
+double timeMethod (Method method, DominatorGraph *g, int r, int *idom, double mintime) {
+        int runs = 0;
+        double t;
+        RFWTimer timer(true);
+        do {
+                runs ++;
+                run (method, g, r, idom);
+        } while ((t=timer.getTime()) < mintime);
+        return 1000000.0 * t / (double)runs;
+}
+
+
+/*-------------------------------------------------------------------
+ | calibrate the cost model used by "auto": time every candidate
+ | method on every graph in the series, fit each method's running 
+ | time as a linear function of the features (least squares on the
+ | relative errors, so that small graphs count as much as big ones), and
+ | save the model; then report how well "auto" does on the series
+ *------------------------------------------------------------------*/
+
+void calibrateSeries (const char *listname, bool reverse, bool simplify, const char *modelfile) {
+        const double mintime = 0.02; //per graph and method
+        const double ridge = 1e-9;   //keeps the normal equations nonsingular
 
-void runSeries (const char *listname, Method method, bool reverse, bool simplify) {
-        const bool dump_violators = false;
-        
         int count, maxn;
         DominatorGraph *glist = createGraphList (listname, reverse, count, maxn, simplify);
         int *idom = new int [maxn+1];
+        double *features = new double [count*NFEATURES];
+        double *times = new double [count*METHODS];
+
+        //normal equations for each method
+        double A[METHODS][NFEATURES*NFEATURES], b[METHODS][NFEATURES];
+        int samples[METHODS];
+        for (int m=0; m<METHODS; m++) {
+                samples[m] = 0;
+                for (int k=0; k<NFEATURES; k++) b[m][k] = 0.0;
+                for (int k=0; k<NFEATURES*NFEATURES; k++) A[m][k] = 0.0;
+        }
+
+        for (int g=0; g<count; g++) {
+                DominatorGraph *graph = &glist[g];
+                int r = graph->getSource();
+                double *f = &features[g*NFEATURES];
+                getFeatures (graph, r, f);
+                fprintf (stderr, "Calibrating on graph %d (%d vertices, %d back arcs)...\n", g+1, graph->getNVertices(), (int)f[3]);
+
+                for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
+                        times[g*METHODS+m] = -1.0; //not measured
+                        if (!isCandidate(m) || (m==DAG && f[3]>0)) continue;
+                        double t = timeMethod (m, graph, r, idom, mintime);
+                        double w = 1.0 / (t*t + 1e-12); //minimize relative (not absolute) errors
+                        times[g*METHODS+m] = t;
+                        for (int i=0; i<NFEATURES; i++) {
+                                b[m][i] += w * f[i] * t;
+                                for (int j=0; j<NFEATURES; j++) A[m][i*NFEATURES+j] += w * f[i] * f[j];
+                        }
+                        samples[m]++;
+                }
+        }
+
+        //fit the model
+        for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
+                modeled[m] = false;
+                if (!samples[m]) continue;
+                for (int i=0; i<NFEATURES; i++) A[m][i*NFEATURES+i] += ridge * (1.0 + A[m][i*NFEATURES+i]);
+                modeled[m] = solveLinear (NFEATURES, A[m], b[m], model[m]);
+                if (!modeled[m]) fprintf (stderr, "WARNING: could not fit model for %s.\n", mname (m));
+        }
+        model_loaded = true;
+        saveModel (modelfile);
+
+        //evaluate the model on the calibration series
+        int hits = 0;
+        double tbest = 0.0, tauto = 0.0;
+        for (int g=0; g<count; g++) {
+                Method best = METHODS;
+                for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
+                        double t = times[g*METHODS+m];
+                        if (t>=0 && (best==METHODS || t<times[g*METHODS+best])) best = m;
+                }
+                Method chosen = selectMethod (&glist[g], glist[g].getSource());
+                if (chosen==best) hits++;
+                tbest += times[g*METHODS+best];
+                tauto += times[g*METHODS+chosen];
+        }
+
+        fprintf (stdout, "series %s\n", listname);
+        fprintf (stdout, "reverse %d\n", (int)reverse);
+        fprintf (stdout, "simplified %d\n", (int)simplify);
+        fprintf (stdout, "graphs %d\n", count);
+        fprintf (stdout, "model %s\n", modelfile);
+        for (Method m=IBFS; m<METHODS; m = (Method)((int)m+1)) {
+                if (!modeled[m]) continue;
+                fprintf (stdout, "samples%s %d\n", mname (m), samples[m]);
+                for (int k=0; k<NFEATURES; k++) {
+                        fprintf (stdout, "coef%s%s %.10g\n", mname (m), fnames[k], model[m][k]);
+                }
+        }
+        fprintf (stdout, "autohits %d\n", hits);
+        fprintf (stdout, "autohitsf %.8f\n", (double)hits/(double)count);
+        fprintf (stdout, "besttimeu %.8f\n", tbest);
+        fprintf (stdout, "autotimeu %.8f\n", tauto);
+        fprintf (stdout, "autoslowdown %.8f\n", tauto/tbest);
+
+        delete [] times;
+        delete [] features;
+        delete [] idom;
+        delete [] glist;
+}
+
+
+/*-------------------------------------------------------------
+ | for method "auto": report which method is chosen for each
+ | graph (a short summary for series, one line per graph otherwise)
+ *------------------------------------------------------------*/
+
+void reportSelection (FILE *file, DominatorGraph *glist, int count) {
+        int selected[METHODS];
+        for (int m=0; m<METHODS; m++) selected[m] = 0;
+        for (int g=0; g<count; g++) {
+                int r = glist[g].getSource();
+                Method m = selectMethod (&glist[g], r);
+                if (count==1) {
+                        fprintf (stderr, "auto: selected %s (vertices %d, density %.4f, backarcs %d, %s)\n", 
+                                 mname (m), glist[g].getNVertices(), 
+                                 (double)glist[g].getNArcs()/(double)glist[g].getNVertices(),
+                                 glist[g].getBackArcs(r), model_loaded ? "model" : "rules");
+                }
+                selected[m]++;
+        }
+        for (int m=0; m<METHODS; m++) {
+                if (!selected[m]) continue;
+                if (count>1) fprintf (stderr, "auto: selected %s for %d graphs\n", mname (m), selected[m]);
+                fprintf (file, "auto%s %d\n", mname (m), selected[m]);
+        }
+}
+
 
+/*------------------------------------------------------------------
+ | benchmark driver: takes samples of 'inner' calls of body() each
+ | until there are SAMPLES samples (or, if SAMPLES is zero, until 
+ | the samples add up to MINTIME seconds); each sample is recorded 
+ | as the average time of one call. Warmup is up to the caller.
+ *-----------------------------------------------------------------*/
+
+template <class Body> int sampleRuns (Body &body, int inner, BenchStats &stats, PerfCounters *perf) {
         int runs = 0;
-        double t = 0;
-        RFWTimer timer(true);
+        double total = 0.0;
+        RFWTimer timer;
         do {
-                runs ++;
+                if (perf) perf->start();
+                timer.start();
+                for (int i=inner; i>0; i--) body();
+                double s = timer.getTime();
+                if (perf) perf->stop();
+                stats.add (s / (double)inner);
+                total += s;
+                runs += inner;
+        } while (SAMPLES ? (stats.getCount() < SAMPLES) : (total < MINTIME));
+
+        stats.summarize();
+        return runs;
+}
+
+
+/*------------------------------------------------------------
+ | machine-readable records (one per invocation, appended to 
+ | the files given by -json and -csv) to compare across builds
+ *-----------------------------------------------------------*/
+
+//s as a JSON string (quotes included)
+void writeJSONString (FILE *file, const char *s) {
+        fputc ('"', file);
+        for (; *s; s++) {
+                unsigned char c = (unsigned char)*s;
+                if (c=='"' || c=='\\') fprintf (file, "\\%c", c);
+                else if (c=='\n') fputs ("\\n", file);
+                else if (c=='\r') fputs ("\\r", file);
+                else if (c=='\t') fputs ("\\t", file);
+                else if (c<0x20) fprintf (file, "\\u%04x", c);
+                else fputc (c, file);
+        }
+        fputc ('"', file);
+}
+
+//s as a CSV field (quoted, with quotes doubled, if it has a comma, quote or line break)
+void writeCSVField (FILE *file, const char *s) {
+        if (!strpbrk (s, ",\"\r\n")) {
+                fputs (s, file);
+                return;
+        }
+        fputc ('"', file);
+        for (; *s; s++) {
+                if (*s=='"') fputc ('"', file);
+                fputc (*s, file);
+        }
+        fputc ('"', file);
+}
+
+void writeRecords (const char *input, Method method, bool reverse, bool simplify, 
+                   int graphs, long long vertices, long long arcs, int inner, BenchStats &stats) {
+#ifdef COUNTOPS
+        const int counting = 1;
+#else
+        const int counting = 0;
+#endif
+#ifdef __VERSION__
+        const char *compiler = __VERSION__;
+#else
+        const char *compiler = "unknown";
+#endif
+        if (JSONFILE) {
+                fprintf (JSONFILE, "{\"input\": ");
+                writeJSONString (JSONFILE, input);
+                fprintf (JSONFILE, ", \"method\": ");
+                writeJSONString (JSONFILE, mname (method));
+                fprintf (JSONFILE, ", \"reverse\": %d, \"simplified\": %d, "
+                                   "\"graphs\": %d, \"vertices\": %lld, \"arcs\": %lld, \"counting\": %d, "
+                                   "\"compiler\": ",
+                         (int)reverse, (int)simplify, graphs, vertices, arcs, counting);
+                writeJSONString (JSONFILE, compiler);
+                fprintf (JSONFILE, ", \"warmup\": %d, \"inner\": %d, ", WARMUP, inner);
+                stats.outputJSON (JSONFILE);
+                fprintf (JSONFILE, "}\n");
+                fflush (JSONFILE);
+        }
+        if (CSVFILE) {
+                if (ftell(CSVFILE)==0) { //new file
+                        fprintf (CSVFILE, "input,method,reverse,simplified,graphs,vertices,arcs,counting,warmup,inner,");
+                        BenchStats::outputCSVHeader (CSVFILE);
+                        fprintf (CSVFILE, "\n");
+                }
+                writeCSVField (CSVFILE, input);
+                fputc (',', CSVFILE);
+                writeCSVField (CSVFILE, mname (method));
+                fprintf (CSVFILE, ",%d,%d,%d,%lld,%lld,%d,%d,%d,", (int)reverse, 
+                         (int)simplify, graphs, vertices, arcs, counting, WARMUP, inner);
+                stats.outputCSV (CSVFILE);
+                fprintf (CSVFILE, "\n");
+                fflush (CSVFILE);
+        }
+}
+
+
+/*-------------------------------------------------------
+ | run a particular method on all graphs in a given list
+ *------------------------------------------------------*/
+
+//one pass over all graphs of a series
+struct SeriesRun {
+        Method method;
+        DominatorGraph *glist;
+        int count;
+        int *idom;
+        PerfCounters *perf;  //if not NULL, read per graph...
+        long long *gperf;    //...and accumulated here
+        void *scratch;       //if not NULL, small graphs use the 16-bit kernels in this block...
+        int *const *idoms;   //...through the batch interface (all entries are idom)
+        int compacted;       //graphs that used them in the last pass
+
+        inline void runGraph (DominatorGraph *graph, int r) {
+                if (scratch && graph->fitsCompact()) {
+                        graph->compact (method==SLT ? DominatorGraph::COMPACT_SLT : DominatorGraph::COMPACT_SNCA, r, idom, scratch);
+                        compacted++;
+                } else run (method, graph, r, idom);
+        }
+
+        void operator() () {
+                if (scratch && !perf) {
+                        compacted = DominatorGraph::compactBatch (method==SLT ? DominatorGraph::COMPACT_SLT : DominatorGraph::COMPACT_SNCA, 
+                                                                  glist, count, idoms, scratch);
+                        return;
+                }
+                compacted = 0;
                 for (int g=0; g<count; g++) {
                         DominatorGraph *graph = &glist[g];
                         int r = graph->getSource();
-                        run (method, graph, r, idom);
+                        if (perf) {
+                                long long *gp = &gperf[g*PerfCounters::NCOUNTERS];
+                                for (int c=0; c<PerfCounters::NCOUNTERS; c++) gp[c] -= perf->getValue(c);
+                                perf->start();
+                                runGraph (graph, r);
+                                perf->stop();
+                                for (int c=0; c<PerfCounters::NCOUNTERS; c++) gp[c] += perf->getValue(c);
+                        } else runGraph (graph, r);
                 }
-        } while ((t=timer.getTime()) < MINTIME);
+        }
+};
+
+//repeated runs of a method on a single graph
+struct GraphRun {
+        Method method;
+        DominatorGraph *g;
+        int r;
+        int *idom;
+
+        void operator() () {run (method, g, r, idom);}
+};
+
+
+void runSeries (const char *listname, Method method, bool reverse, bool simplify) {
+        const bool dump_violators = false;
+        
+        int count, maxn;
+        DominatorGraph *glist = createGraphList (listname, reverse, count, maxn, simplify);
+        int *idom = mpNew<int> (maxn+1);
+
+        if (method==AUTO) reportSelection (stdout, glist, count);
+
+        /*---
+         | with -perf, counters are read around every graph so that
+         | they can be reported per graph (this adds a few system 
+         | calls per graph to the measured time)
+         *--*/
+        PerfCounters &perf = PERFCOUNTERS;
+        long long *gperf = NULL; //counters per graph
+        if (PERF) {
+                gperf = new long long [count*PerfCounters::NCOUNTERS];
+                for (int i=count*PerfCounters::NCOUNTERS-1; i>=0; i--) gperf[i] = 0;
+        }
+
+        //each sample is one pass over the series
+        SeriesRun body;
+        body.method = method;
+        body.glist = glist;
+        body.count = count;
+        body.idom = idom;
+        body.perf = PERF ? &perf : NULL;
+        body.gperf = gperf;
+
+        //snca and slt run graphs with at most COMPACT_MAX vertices through the 16-bit kernels
+        bool compact = COMPACT && (method==SNCA || method==SLT);
+        char *scratch = compact ? mpNew<char> (DominatorGraph::getCompactScratch (maxn)) : NULL;
+        int **idoms = compact ? new int * [count] : NULL;
+        for (int g=0; compact && g<count; g++) idoms[g] = idom;
+        body.scratch = scratch;
+        body.idoms = idoms;
+        body.compacted = 0;
+
+        body.perf = NULL; //no counters during warmup
+        for (int i=0; i<WARMUP; i++) body();
+        body.perf = PERF ? &perf : NULL;
+
+        BenchStats stats;
+        int runs = sampleRuns (body, 1, stats, NULL);
+        double t = stats.getTotal();
 
 
         /*---
@@ -316,10 +913,12 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
         int *marked = new int[count];
         vsum = asum = 0;
         dsum = ops = opsv = itsum = sp = spf = 0.0;
+        long long arcbytes = 0;
         for (int g=0; g<count; g++) {
                 DominatorGraph *graph = &glist[g];
                 int n = graph->getNVertices();
                 int m = graph->getNArcs();
+                arcbytes += graph->getArcBytes();
                 vsum += n; //vertices
                 asum += m; //arcs
                 dsum += (double)m/(double)n; //density
@@ -327,17 +926,17 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
                 opsv += graph->ccount / (double)n;
 
                 if (dump_violators) {
-                        int itc = graph->icount;
+                        long long itc = graph->icount;
                         if (itc>2) {
-                                fprintf (stderr, "Graph %d has %d iterations.\n", g, itc);
+                                fprintf (stderr, "Graph %d has %lld iterations.\n", g, itc);
                         }
-                        marked[g] = (itc);
+                        marked[g] = (int)(itc);
                 }
 
                 itsum += graph->icount;
                 sp += graph->scount;
                 if (n>1) {
-                        spf += (int) graph->scount / (double)(n-1);
+                        spf += graph->scount / (double)(n-1);
                 }
                 //itvsum += (double)graph->icount / (double)n;
         }
@@ -346,7 +945,7 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
         delete [] marked;
 
         double avg = t / (double)runs;
-        fprintf (stdout, "method %s\n", mnames[method]);
+        fprintf (stdout, "method %s\n", mname (method));
         fprintf (stdout, "reverse %d\n", (int)reverse); 
         fprintf (stdout, "series %s\n", listname);
         fprintf (stdout, "runs %d\n", runs);
@@ -359,6 +958,9 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
         fprintf (stdout, "vtimeu %.8f\n", 1000000.0 * avg / (vsum));
         fprintf (stdout, "atimeu %.8f\n", 1000000.0 * avg / (asum));
         fprintf (stdout, "stimeu %.8f\n", 1000000.0 * avg / (asum+vsum));
+        fprintf (stdout, "warmup %d\n", WARMUP);
+        stats.output (stdout, "sample"); //distribution of the time per pass over the series
+        writeRecords (listname, method, reverse, simplify, count, vsum, asum, 1, stats);
 
         fprintf (stdout, "simplified %d\n", (int)simplify);
 
@@ -368,6 +970,12 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
         fprintf (stdout, "avgv %.8f\n", (double)vsum/(double)count);
         fprintf (stdout, "totala %d\n", asum);
         fprintf (stdout, "avga %.8f\n", (double)asum/(double)count);
+        fprintf (stdout, "compressed %d\n", (int)COMPRESS);
+        fprintf (stdout, "compact %d\n", (int)compact);
+        fprintf (stdout, "compactgraphs %d\n", body.compacted);
+        if (compact) fprintf (stdout, "compactscratch %lu\n", (unsigned long)DominatorGraph::getCompactScratch (maxn));
+        fprintf (stdout, "arcbytes %lld\n", arcbytes);
+        fprintf (stdout, "arcbytesa %.4f\n", asum ? (double)arcbytes/(double)asum : 0.0);
         fprintf (stdout, "totald %.8f\n", dsum);
         fprintf (stdout, "avgd %.8f\n", (double)dsum/(double)count);
         fprintf (stdout, "ops %.0f\n", ops);
@@ -379,18 +987,101 @@ void runSeries (const char *listname, Method method, bool reverse, bool simplify
         fprintf (stdout, "spf %.8f\n", spf/(double)count);
         fprintf (stdout, "itcount %.0f\n", itsum);
         fprintf (stdout, "itcountg %.8f\n", (double)itsum / (double)count);
+        LOADER.output (stdout);
+
+        if (PERF) {
+                fprintf (stdout, "perf %d\n", perf.getNAvailable());
+                perf.output (stdout, runs);
+                for (int c=0; c<PerfCounters::NCOUNTERS; c++) {
+                        if (!perf.isAvailable(c)) continue;
+                        fprintf (stdout, "%sg %.2f\n", PerfCounters::getName(c), (double)perf.getValue(c)/(double)(runs*count));
+                }
+                if (perf.isAvailable(PerfCounters::DTLBMISSES)) {
+                        fprintf (stdout, "dtlbmissesv %.4f\n", (double)perf.getValue(PerfCounters::DTLBMISSES)/((double)runs*(double)vsum));
+                }
+
+                //per-graph averages (per run) go to stderr as a table
+                if (perf.getNAvailable()) {
+                        fprintf (stderr, "%6s %10s", "graph", "vertices");
+                        for (int c=0; c<PerfCounters::NCOUNTERS; c++) {
+                                if (perf.isAvailable(c)) fprintf (stderr, " %14s", PerfCounters::getName(c));
+                        }
+                        fprintf (stderr, "\n");
+                        for (int g=0; g<count; g++) {
+                                fprintf (stderr, "%6d %10d", g+1, glist[g].getNVertices());
+                                for (int c=0; c<PerfCounters::NCOUNTERS; c++) {
+                                        if (perf.isAvailable(c)) fprintf (stderr, " %14.0f", (double)gperf[g*PerfCounters::NCOUNTERS+c]/(double)runs);
+                                }
+                                fprintf (stderr, "\n");
+                        }
+                }
+                delete [] gperf;
+        }
+        MemPolicy::output (stdout);
         //fprintf (stderr, "itcountv %.8f\n", (double)itsum / (double)vsum);
         //fprintf (stderr, "aitcountv %.8f\n", (double)itvsum / (double)count);
 
         
 
 
-        delete [] idom;
+        mpDelete (idom);
+        if (scratch) mpDelete (scratch);
+        delete [] idoms;
         delete [] glist;
 
 }
 
 
+/*------------------------------------------------------------------
+ | one end-to-end pass over a series through the reader/compute/
+ | writer pipeline (graphs are never all in memory at once)
+ *-----------------------------------------------------------------*/
+
+static void computeIdoms (DominatorGraph *g, int *idom, void *context) {
+        run (*(Method *)context, g, g->getSource(), idom);
+}
+
+void runPipeline (const char *listname, Method method, bool reverse, bool simplify, FILE *idomfile) {
+        SeriesPipeline pipeline (PIPELINE, READERS, WORKERS);
+        pipeline.run (listname, reverse, simplify, COMPRESS, computeIdoms, &method, &WRITER, idomfile);
+        if (pipeline.writeFailed()) fatal ("error writing immediate dominators");
+
+        fprintf (stdout, "method %s\n", mname (method));
+        fprintf (stdout, "reverse %d\n", (int)reverse);
+        fprintf (stdout, "series %s\n", listname);
+        fprintf (stdout, "simplified %d\n", (int)simplify);
+        fprintf (stdout, "compressed %d\n", (int)COMPRESS);
+        pipeline.output (stdout);
+        if (idomfile) WRITER.output (stdout);
+        MemPolicy::output (stdout);
+}
+
+
+/*--------------------------------------------------------------
+ | dominator service on a Unix socket (see dom_server.h); runs 
+ | until a client asks it to shut down
+ *-------------------------------------------------------------*/
+
+static bool computeNamed (DominatorGraph *g, const char *name, int *idom) {
+        Method m = getMethod (name);
+        if (m==METHODS || m<IBFS) return false; //auxiliary methods produce no idoms
+        run (m, g, g->getSource(), idom);
+        return true;
+}
+
+void runServer (const char *path) {
+        Method m = getMethod (SERVERMETHOD);
+        if (m==METHODS || m<IBFS) fatal ("unknown method for the server");
+        loadModel (MODELFILE); //without one, "auto" uses the default rules
+
+        DominatorServer server (path, WORKERS, SERVERMETHOD, computeNamed);
+        if (!server.run()) exit(-1);
+        fprintf (stdout, "method %s\n", SERVERMETHOD);
+        server.output (stdout);
+        MemPolicy::output (stdout);
+}
+
+
 /*----------------------------------
  | run all tests for a given graph 
  *---------------------------------*/
@@ -401,33 +1092,68 @@ void runTests (const char *filename, Method method, bool reverse, bool simplify,
          | read the graph 
          *---------------*/
         DominatorGraph g;
-        g.readDimacs(filename, reverse, simplify); //WARNING: MAKE SURE REVERSE IS INTERPRETED CORRECTLY
+        loadGraph (g, filename, reverse, simplify);
         int r = g.getSource();
+        if (method==AUTO) reportSelection (stdout, &g, 1);
 
         /*---------------------------------
          | run the algorithm several times
          *--------------------------------*/
-        int *idom = new int [g.getNVertices()+1];
+        int *idom = mpNew<int> (g.getNVertices()+1);
         int inner = 100000/g.getNVertices() + 1;
-        if (MINTIME < 1) inner = 1;
-        int runs = 0;
-
-        RFWTimer timer(true);
-        double t;
-        do {
-                for (int i=inner; i>0; i--) {
-                        runs ++;
-                        run (method, &g, r, idom);
-                }
-        } while ((t=timer.getTime()) < MINTIME);
+        if (MINTIME < 1 || SAMPLES) inner = 1;
+        if (INNER) inner = INNER;
+
+        PerfCounters &perf = PERFCOUNTERS;
+
+        GraphRun body;
+        body.method = method;
+        body.g = &g;
+        body.r = r;
+        body.idom = idom;
+        long long live = MemPolicy::resetPeak(); //the graph and idom
+        for (int i=0; i<WARMUP; i++) body();
+
+        g.resetPhases();
+        BenchStats stats;
+        int runs = sampleRuns (body, inner, stats, PERF ? &perf : NULL);
+        double t = stats.getTotal();
+
+        //memory: the method's scratch at its largest, and the process's peak resident set
+        long long scratch = MemPolicy::getPeak() - live;
+#ifndef WIN32
+        struct rusage usage;
+        getrusage (RUSAGE_SELF, &usage);
+        long long peakrss = (long long)usage.ru_maxrss; //kilobytes
+#endif
 
         if (idomfile) {
-                for (int i=1; i<=g.getNVertices(); i++) {
-                        fprintf (idomfile, "%d %d\n", i, idom[i]);
-                }
+                if (!WRITER.write (idomfile, g.getNVertices(), idom, r)) fatal ("error writing immediate dominators");
         }
 
-        delete [] idom;
+        //materialized dominator tree (built once, after the measured runs)
+        DominatorTree tree;
+        double ttree = 0.0;
+        if (TREE || RETAINED>=0) {
+                RFWTimer timer(true);
+                g.buildTree (r, idom, tree, getNThreads()>1);
+                ttree = timer.getTime();
+        }
+
+        //retained sizes (total weight dominated by each vertex) and the top retainers
+        long long *retained = NULL;
+        int *top = NULL, ntop = 0;
+        double tretained = 0.0;
+        if (RETAINED>=0) {
+                RFWTimer timer(true);
+                retained = mpNew<long long> (g.getNVertices()+1);
+                g.getRetained (tree, retained, getNThreads()>1);
+                top = new int [RETAINED+1];
+                ntop = tree.getTopK (retained, RETAINED, top);
+                tretained = timer.getTime();
+        }
+
+        mpDelete (idom);
 
 
         /*-------------------
@@ -439,7 +1165,7 @@ void runTests (const char *filename, Method method, bool reverse, bool simplify,
         g.outputGraphStatistics (stdout); //vertices, edges, size, density...
 
         //input parameters
-        fprintf (stdout, "method %s\n", mnames[method]);
+        fprintf (stdout, "method %s\n", mname (method));
         fprintf (stdout, "reverse %d\n", (int)reverse);
         fprintf (stdout, "simplifed %d\n", (int)simplify);
 
@@ -453,15 +1179,102 @@ void runTests (const char *filename, Method method, bool reverse, bool simplify,
         fprintf (stdout, "avgtime %.8f\n", avg);
         fprintf (stdout, "avgtimem %.8f\n", 1000.0 * avg);
         fprintf (stdout, "avgtimeu %.8f\n", 1000000.0 * avg);
+        fprintf (stdout, "warmup %d\n", WARMUP);
+        stats.output (stdout, "sample"); //distribution of the time per run
+        writeRecords (filename, method, reverse, simplify, 1, g.getNVertices(), g.getNArcs(), inner, stats);
 
         //special data (may be meaningless for certain methods)
-        fprintf (stdout, "iterations %d\n", g.icount);
-        fprintf (stdout, "semiparent %d\n", g.scount);
+        fprintf (stdout, "iterations %lld\n", g.icount);
+        fprintf (stdout, "semiparent %lld\n", g.scount);
         if (g.getNVertices() > 1) {
                 fprintf (stdout, "semiparentf %.8f\n", (double)g.scount/(double)(g.getNVertices()-1));
         }
-        fprintf (stdout, "comparisons %d\n", g.ccount);
+        fprintf (stdout, "comparisons %lld\n", g.ccount);
         fprintf (stdout, "rcomparisons %.8f\n", (double)g.ccount/(double)g.getNVertices());
+
+        //memory (bytes per vertex)
+        fprintf (stdout, "scratchbytes %lld\n", scratch);
+        fprintf (stdout, "scratchv %.4f\n", (double)scratch/(double)g.getNVertices());
+#ifndef WIN32
+        fprintf (stdout, "peakrss %lld\n", peakrss);
+        fprintf (stdout, "peakrssv %.4f\n", 1024.0*(double)peakrss/(double)g.getNVertices());
+#endif
+        if (method==BFS || method==BFSDO || method==IBFS || method==IBFSDO) {
+                fprintf (stdout, "bfsarcs %lld\n", g.bfsarcs); //in the last run
+                fprintf (stdout, "bfsarcsa %.4f\n", g.getNArcs() ? (double)g.bfsarcs/(double)g.getNArcs() : 0.0);
+                if (method==BFSDO || method==IBFSDO) {
+                        fprintf (stdout, "bfstopdown %d\n", g.bfstd);
+                        fprintf (stdout, "bfsbottomup %d\n", g.bfsbu);
+                }
+        }
+
+        //per-phase breakdown (average per run)
+#ifdef PHASES
+        double ptotal = 0.0;
+        for (int p=0; p<DominatorGraph::NPHASES; p++) ptotal += g.phasetime[p];
+        for (int p=0; p<DominatorGraph::NPHASES; p++) {
+                if (g.phasetime[p]==0.0) continue; //phase not used by this method
+                const char *pname = DominatorGraph::getPhaseName(p);
+                fprintf (stdout, "phase%su %.8f\n", pname, 1000000.0 * g.phasetime[p] / (double)runs);
+                fprintf (stdout, "phase%sf %.8f\n", pname, g.phasetime[p] / ptotal);
+#ifdef COUNTOPS
+                fprintf (stdout, "phase%sops %.2f\n", pname, (double)g.phaseops[p] / (double)runs);
+#endif
+        }
+#endif
+
+        //hardware counters (totals and per run)
+        if (PERF) {
+                fprintf (stdout, "perf %d\n", perf.getNAvailable());
+                perf.output (stdout, runs);
+                if (perf.isAvailable(PerfCounters::DTLBMISSES)) {
+                        fprintf (stdout, "dtlbmissesv %.4f\n", (double)perf.getValue(PerfCounters::DTLBMISSES)/((double)runs*(double)g.getNVertices()));
+                }
+        }
+        if (idomfile) WRITER.output (stdout);
+        if (TREE) {
+                fprintf (stdout, "treetime %.6f\n", ttree);
+                tree.output (stdout);
+        }
+        if (RETAINED>=0) {
+                fprintf (stdout, "retainedtime %.6f\n", tretained);
+                fprintf (stdout, "retainedtotal %lld\n", retained[r]);
+                fprintf (stdout, "retainedk %d\n", ntop);
+
+                //the top retainers go to stderr as a table
+                fprintf (stderr, "%6s %10s %16s %16s\n", "rank", "vertex", "retained", "shallow");
+                for (int i=0; i<ntop; i++) {
+                        fprintf (stderr, "%6d %10d %16lld %16lld\n", i+1, top[i], retained[top[i]], g.getWeight(top[i]));
+                }
+                delete [] top;
+                mpDelete (retained);
+        }
+        MemPolicy::output (stdout);
+}
+
+
+/*-----------------------------------------------------------------
+ | semi-external run: the arcs stay on disk, and only vertex arrays 
+ | (plus buffers) are kept in memory, within MEMCAP megabytes
+ *----------------------------------------------------------------*/
+
+void runSemiExternal (const char *filename, bool reverse, FILE *idomfile = NULL) {
+        SemiExternalDominators g (TMPDIR, (size_t)MEMCAP << 20);
+        g.readDimacs (filename, reverse);
+        int n = g.getNVertices();
+        int *idom = new int [n+1];
+        g.snca (g.getSource(), idom);
+
+        if (idomfile) {
+                if (!WRITER.write (idomfile, n, idom, g.getSource())) fatal ("error writing immediate dominators");
+        }
+        delete [] idom;
+
+        fprintf (stdout, "filename %s\n", filename);
+        fprintf (stdout, "method semiext\n");
+        fprintf (stdout, "reverse %d\n", (int)reverse);
+        g.outputStatistics (stdout);
+        if (idomfile) WRITER.output (stdout);
 }
 
 
@@ -482,6 +1295,9 @@ int main(int argc, char *argv[]) {
         bool reverse = false;   //compute dominators (false) or postdominators (true)
         bool simplify = false;  //eliminate parallel edges before computing dominators?
 
+        //series cache: DOMCACHE sets the default directory
+        if (getenv ("DOMCACHE")) LOADER.setCache (getenv ("DOMCACHE"));
+
         //read options
         if (argc>3) {
                 for (int i=3; i<argc; i++) {
@@ -505,11 +1321,69 @@ int main(int argc, char *argv[]) {
                         if (strcmp(argv[i],"-idomfile")==0) {
                                 i++;
                                 if (i==argc) fatal ("-idomfile requires an argument");
-                                idomfile = fopen (argv[i], "w");
+                                idomfile = fopen (argv[i], "wb");
                                 if (!idomfile) fatal ("cannot open file for writing");
                                 continue;
                         }
 
+                        if (strcmp(argv[i],"-idomformat")==0) {
+                                i++;
+                                if (i==argc) fatal ("-idomformat requires an argument");
+                                IdomWriter::Format f;
+                                if (!IdomWriter::parseFormat (argv[i], f)) fatal ("unknown idom format");
+                                WRITER.setFormat (f);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-perf")==0) {
+                                PERF = true;
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-model")==0) {
+                                i++;
+                                if (i==argc) fatal ("-model requires an argument");
+                                MODELFILE = argv[i];
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-warmup")==0) {
+                                i++;
+                                if (i==argc) fatal ("-warmup requires an argument");
+                                WARMUP = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-samples")==0) {
+                                i++;
+                                if (i==argc) fatal ("-samples requires an argument");
+                                SAMPLES = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-inner")==0) {
+                                i++;
+                                if (i==argc) fatal ("-inner requires an argument");
+                                INNER = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-json")==0) {
+                                i++;
+                                if (i==argc) fatal ("-json requires an argument");
+                                JSONFILE = fopen (argv[i], "a");
+                                if (!JSONFILE) fatal ("cannot open file for writing");
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-csv")==0) {
+                                i++;
+                                if (i==argc) fatal ("-csv requires an argument");
+                                CSVFILE = fopen (argv[i], "a");
+                                if (!CSVFILE) fatal ("cannot open file for writing");
+                                continue;
+                        }
+
                         if (strcmp(argv[i],"-mintime")==0) {
                                 i++;
                                 if (i==argc) fatal ("-mintime requires an argument");
@@ -517,6 +1391,113 @@ int main(int argc, char *argv[]) {
                                 continue;
                         }
 
+                        if (strcmp(argv[i],"-pages")==0) {
+                                i++;
+                                if (i==argc) fatal ("-pages requires an argument");
+                                if (!MemPolicy::setPages(argv[i])) fatal ("unknown page policy");
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-numa")==0) {
+                                i++;
+                                if (i==argc) fatal ("-numa requires an argument");
+                                if (!MemPolicy::setNuma(argv[i])) fatal ("unknown numa policy (or node)");
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-threads")==0) {
+                                i++;
+                                if (i==argc) fatal ("-threads requires an argument");
+#ifdef _OPENMP
+                                omp_set_num_threads (atoi(argv[i]));
+#else
+                                if (atoi(argv[i])>1) fprintf (stderr, "WARNING: built without OpenMP; -threads ignored.\n");
+#endif
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-tree")==0) {
+                                TREE = true;
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-retained")==0) {
+                                i++;
+                                if (i==argc) fatal ("-retained requires an argument");
+                                RETAINED = atoi(argv[i]);
+                                if (RETAINED<0) fatal ("-retained requires a nonnegative argument");
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-pipeline")==0) {
+                                i++;
+                                if (i==argc) fatal ("-pipeline requires an argument");
+                                PIPELINE = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-readers")==0) {
+                                i++;
+                                if (i==argc) fatal ("-readers requires an argument");
+                                READERS = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-workers")==0) {
+                                i++;
+                                if (i==argc) fatal ("-workers requires an argument");
+                                WORKERS = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-method")==0) {
+                                i++;
+                                if (i==argc) fatal ("-method requires an argument");
+                                SERVERMETHOD = argv[i];
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-compress")==0) {
+                                COMPRESS = true;
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-no-compact")==0) {
+                                COMPACT = false;
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-lowmem")==0) {
+                                LOWMEM = true;
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-cache")==0) {
+                                i++;
+                                if (i==argc) fatal ("-cache requires an argument");
+                                LOADER.setCache (argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-no-cache")==0) {
+                                LOADER.setCache (NULL);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-memcap")==0) {
+                                i++;
+                                if (i==argc) fatal ("-memcap requires an argument");
+                                MEMCAP = atoi(argv[i]);
+                                continue;
+                        }
+
+                        if (strcmp(argv[i],"-tmpdir")==0) {
+                                i++;
+                                if (i==argc) fatal ("-tmpdir requires an argument");
+                                TMPDIR = argv[i];
+                                continue;
+                        }
+
                         fprintf (stderr, "WARNING: unrecognized option \"%s\".\n", argv[i]);
                         //fprintf (stderr, "Setting mintime do %d.\n", m);
                 }
@@ -535,6 +1516,8 @@ int main(int argc, char *argv[]) {
         //read method
         char *method = argv[2];
 
+        if (PERF && !PERFCOUNTERS.open()) fprintf (stderr, "WARNING: no hardware performance counters available.\n");
+
         //special case: checks all methods
         printBasics(stdout);
         if (strcmp(method, "-check") == 0) {
@@ -542,15 +1525,28 @@ int main(int argc, char *argv[]) {
                         checkSeries (filename, reverse, simplify);
                 } else {
                         DominatorGraph g;
-                        g.readDimacs(filename, reverse, simplify); //WARNING: MAKE SURE REVERSE IS INTERPRETED CORRECTLY
+                        loadGraph (g, filename, reverse, simplify);
                         int r = g.getSource();
                         check (&g, r);
                 }
+        } else if (strcmp(method, "-server") == 0) {
+                runServer (filename);
+        } else if (strcmp(method, "-semiext") == 0) {
+                if (series) fatal ("-semiext requires a single graph");
+                runSemiExternal (filename, reverse, idomfile);
+        } else if (strcmp(method, "-calibrate") == 0) {
+                if (!series) fatal ("-calibrate requires a series");
+                calibrateSeries (filename, reverse, simplify, MODELFILE);
         } else {
                 Method m = getMethod(method);
                 if (m==METHODS) fatal ("uknown method");
+                if (m==AUTO && !loadModel(MODELFILE)) {
+                        fprintf (stderr, "WARNING: no cost model in \"%s\" (run -calibrate); using default rules.\n", MODELFILE);
+                }
 
-                if (series) {
+                if (series && PIPELINE>0) {
+                        runPipeline (filename, m, reverse, simplify, idomfile);
+                } else if (series) {
                         runSeries (filename, m, reverse, simplify);
                 } else {
                         runTests (filename, m, reverse, simplify, idomfile);
@@ -558,5 +1554,7 @@ int main(int argc, char *argv[]) {
         }
 
         if (idomfile) fclose(idomfile);
+        if (JSONFILE) fclose(JSONFILE);
+        if (CSVFILE) fclose(CSVFILE);
         return 0;
 }
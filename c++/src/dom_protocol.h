@@ -0,0 +1,56 @@
+/**********************************************************
+ *
+ * wire format of the dominator server (dom -server) and
+ * its client (domclient), over a local Unix socket
+ * - a request is a DomRequest followed by 'length' bytes:
+ *   - DOM_ARCS: m arcs as pairs of int (v,w), on vertices
+ *     1..n, with the given source
+ *   - DOM_DIMACS: a DIMACS text (n and source come from its
+ *     'p' line, whose m cannot exceed what 'length' bytes
+ *     of "a v w" lines could hold)
+ *   - graphs with more than DOM_MAXVERTICES vertices, or
+ *     that the server has no memory for, get DOM_EGRAPH
+ *   - DOM_STATS, DOM_SHUTDOWN: no payload
+ * - every request gets one DomReply followed by 'length' 
+ *   bytes: idom[0..n] as ints if status is DOM_OK (idom[0]
+ *   is 0), or a text (statistics or an error message)
+ * - a client may send several requests before reading the
+ *   replies; replies carry the id of their request and may
+ *   arrive in any order
+ * - integers are in host byte order (the socket is local)
+ *
+ **********************************************************/
+
+#ifndef dom_protocol_h
+#define dom_protocol_h
+
+#define DOM_REQUEST_MAGIC 0x514d4f44 //"DOMQ"
+#define DOM_REPLY_MAGIC   0x524d4f44 //"DOMR"
+#define DOM_MAXPAYLOAD    (1u<<30)
+#define DOM_MAXVERTICES   (1<<26)
+#define DOM_MINARCLINE    6 //bytes of the shortest arc line ("a 1 1\n")
+
+enum {DOM_ARCS=1, DOM_DIMACS=2, DOM_STATS=3, DOM_SHUTDOWN=4};      //request types
+enum {DOM_REVERSE=1, DOM_SIMPLIFY=2};                               //request flags
+enum {DOM_OK=0, DOM_EREQUEST=1, DOM_EMETHOD=2, DOM_EGRAPH=3};       //reply status
+
+typedef struct {
+	unsigned int magic;  //DOM_REQUEST_MAGIC
+	unsigned int type;
+	unsigned int flags;
+	unsigned int id;     //chosen by the client, echoed in the reply
+	int n, source;       //DOM_ARCS only
+	unsigned int length; //bytes that follow
+	char method[20];     //method name (empty: the server's default)
+} DomRequest;
+
+typedef struct {
+	unsigned int magic;  //DOM_REPLY_MAGIC
+	unsigned int status;
+	unsigned int id;
+	int n;               //vertices (DOM_OK)
+	unsigned int length; //bytes that follow
+	unsigned int unused;
+} DomReply;
+
+#endif
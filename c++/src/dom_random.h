@@ -0,0 +1,26 @@
+/*----------------------------------------------------
+ | small self-contained random number generator 
+ | (splitmix64), so that generated data does not 
+ | depend on the C library; used by domgen and 
+ | domkernels
+ *---------------------------------------------------*/
+
+#ifndef DOM_RANDOM_H
+#define DOM_RANDOM_H
+
+class Random {
+	private:
+		unsigned long long state;
+	public:
+		Random (unsigned long long seed) {state = seed;}
+		unsigned long long next() {
+			unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+		int get (int k) {return (int)(next() % (unsigned long long)k);} //in [0,k)
+		int get (int a, int b) {return a + get(b-a+1);}                 //in [a,b]
+};
+
+#endif
@@ -0,0 +1,453 @@
+/*************************************
+ *
+ * DominatorServer (see dom_server.h)
+ *
+ *************************************/
+
+#include "dom_server.h"
+#include "dom_protocol.h"
+#include "dom_thread.h"
+#include "series_loader.h"
+#include "mem_policy.h"
+#include <string.h>
+#include <stdlib.h>
+#include <new>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+struct DominatorServer::Connection {
+	DominatorServer *server;
+	int fd;
+	DomThread thread;
+	std::mutex writelock;  //replies are written whole
+	std::mutex lock;       //protects pending
+	std::condition_variable idle;
+	int pending;           //queued requests not yet answered
+	volatile bool done;    //thread finished (fd closed)
+};
+
+struct DominatorServer::Job {
+	Connection *c;
+	DomRequest request;
+	char *payload;  //zero-terminated
+	RFWTimer arrival;
+	Job() : arrival(true) {}
+};
+
+//per-worker buffers, reused across requests (they only grow)
+struct DominatorServer::Workspace {
+	DominatorGraph g;
+	char *storage; size_t storagebytes;
+	int *arcs; size_t arcsints;
+	int *idom; size_t idomints;
+	Workspace() : storage(NULL), storagebytes(0), arcs(NULL), arcsints(0), idom(NULL), idomints(0) {}
+	~Workspace() {
+		g.destroy();
+		if (storage) mpDelete (storage);
+		if (arcs) mpDelete (arcs);
+		if (idom) mpDelete (idom);
+	}
+};
+
+//may throw std::bad_alloc (a and size are then empty)
+template <class T> static void grow (T *&a, size_t &size, size_t need) {
+	if (need<=size) return;
+	if (a) mpDelete (a);
+	a = NULL;
+	size = 0;
+	a = mpNew<T> (need + need/4);
+	size = need + need/4;
+}
+
+
+DominatorServer::DominatorServer (const char *_path, int _nworkers, const char *_defaultmethod, ComputeFunction _compute) : uptime(true) {
+	path = _path;
+	nworkers = (_nworkers<1) ? 1 : _nworkers;
+	maxjobs = 64 * (size_t)nworkers;
+	team = DomThread::teamSize (nworkers);
+	defaultmethod = _defaultmethod;
+	compute = _compute;
+	listenfd = -1;
+	stopping = false;
+	readersdone = false;
+	nrequests = nerrors = nvertices = narcs = bytesin = bytesout = 0;
+	nconnections = nactive = 0;
+	tcompute = 0.0;
+}
+
+void DominatorServer::runWorker (void *self) {((DominatorServer *)self)->worker();}
+void DominatorServer::runConnection (void *arg) {
+	Connection *c = (Connection *)arg;
+	c->server->connection (c);
+}
+
+
+#ifndef WIN32
+
+static bool readFull (int fd, void *data, size_t bytes) {
+	char *p = (char *)data;
+	while (bytes) {
+		ssize_t k = recv (fd, p, bytes, 0);
+		if (k<=0) return false;
+		p += k;
+		bytes -= k;
+	}
+	return true;
+}
+
+static bool writeFull (int fd, const void *data, size_t bytes) {
+	const char *p = (const char *)data;
+	while (bytes) {
+		ssize_t k = send (fd, p, bytes, MSG_NOSIGNAL);
+		if (k<=0) return false;
+		p += k;
+		bytes -= k;
+	}
+	return true;
+}
+
+
+/*----------
+ | replies
+ *---------*/
+
+void DominatorServer::reply (Connection *c, unsigned int status, unsigned int id, int n, const void *payload, size_t bytes) {
+	DomReply r;
+	r.magic = DOM_REPLY_MAGIC;
+	r.status = status;
+	r.id = id;
+	r.n = n;
+	r.length = (unsigned int)bytes;
+	r.unused = 0;
+	{
+		std::lock_guard<std::mutex> guard (c->writelock);
+		if (writeFull (c->fd, &r, sizeof(r)) && bytes) writeFull (c->fd, payload, bytes);
+	}
+	std::lock_guard<std::mutex> guard (statslock);
+	bytesout += sizeof(r) + bytes;
+}
+
+void DominatorServer::replyError (Connection *c, unsigned int status, unsigned int id, const char *message) {
+	reply (c, status, id, 0, message, strlen (message));
+	std::lock_guard<std::mutex> guard (statslock);
+	nerrors++;
+}
+
+char *DominatorServer::statsText (size_t &bytes) {
+	char *text = NULL;
+	FILE *file = open_memstream (&text, &bytes);
+	output (file);
+	fclose (file);
+	return text;
+}
+
+
+/*-----------------------------------------------------------------
+ | connection thread: reads requests and queues graphs for the 
+ | workers; stats and shutdown requests are answered right away
+ *----------------------------------------------------------------*/
+
+void DominatorServer::connection (Connection *c) {
+	while (1) {
+		DomRequest request;
+		if (!readFull (c->fd, &request, sizeof(request))) break;
+		request.method[sizeof(request.method)-1] = 0;
+		if (request.magic!=DOM_REQUEST_MAGIC || request.length>DOM_MAXPAYLOAD) {
+			replyError (c, DOM_EREQUEST, request.id, "bad request header");
+			break; //cannot resynchronize
+		}
+		char *payload = (char *)malloc (request.length + 1);
+		if (!payload || !readFull (c->fd, payload, request.length)) {
+			free (payload);
+			break;
+		}
+		payload[request.length] = 0;
+		{
+			std::lock_guard<std::mutex> guard (statslock);
+			bytesin += sizeof(request) + request.length;
+		}
+
+		if (request.type==DOM_STATS) {
+			size_t bytes;
+			char *text = statsText (bytes);
+			reply (c, DOM_OK, request.id, 0, text, bytes);
+			free (text);
+			free (payload);
+		} else if (request.type==DOM_SHUTDOWN) {
+			stopping = true;
+			reply (c, DOM_OK, request.id, 0, NULL, 0);
+			free (payload);
+		} else if (request.type==DOM_ARCS || request.type==DOM_DIMACS) {
+			Job *job = new Job;
+			job->c = c;
+			job->request = request;
+			job->payload = payload;
+			{
+				std::lock_guard<std::mutex> guard (c->lock);
+				c->pending++;
+			}
+			std::unique_lock<std::mutex> guard (lock);
+			while (jobs.size()>=maxjobs) jobspace.wait (guard);
+			jobs.push_back (job);
+			jobready.notify_one();
+		} else {
+			replyError (c, DOM_EREQUEST, request.id, "unknown request type");
+			free (payload);
+		}
+	}
+
+	//answer what is queued before closing
+	{
+		std::unique_lock<std::mutex> guard (c->lock);
+		while (c->pending>0) c->idle.wait (guard);
+	}
+	close (c->fd);
+	{
+		std::lock_guard<std::mutex> guard (statslock);
+		nactive--;
+	}
+	c->done = true;
+}
+
+
+/*-------------------------------------------------------
+ | builds the graph of a request in the workspace and 
+ | replies with its idoms (false: the request was bad)
+ *------------------------------------------------------*/
+
+bool DominatorServer::process (Job *job, Workspace &ws) {
+	const DomRequest &request = job->request;
+	bool reverse = (request.flags & DOM_REVERSE)!=0;
+	bool simplify = (request.flags & DOM_SIMPLIFY)!=0;
+	int n, m, src;
+	int *arcs;
+
+	if (request.type==DOM_ARCS) {
+		n = request.n;
+		src = request.source;
+		m = (int)(request.length / (2*sizeof(int)));
+		arcs = (int *)job->payload;
+		if (reverse) {
+			for (int i=0; i<m; i++) {int t = arcs[2*i]; arcs[2*i] = arcs[2*i+1]; arcs[2*i+1] = t;}
+		}
+	} else {
+		const char *p = job->payload;
+		while (*p && *p!='p') { //skip comments
+			while (*p && *p!='\n') p++;
+			if (*p) p++;
+		}
+		int snk;
+		if (sscanf (p, "p %d %d %d %d", &n, &m, &src, &snk)!=4 || m<0) {
+			replyError (job->c, DOM_EGRAPH, request.id, "cannot read the 'p' line");
+			return false;
+		}
+		if ((size_t)m > request.length / DOM_MINARCLINE) {
+			replyError (job->c, DOM_EGRAPH, request.id, "more arcs than the payload holds");
+			return false;
+		}
+		if (reverse) src = snk;
+		arcs = NULL;
+	}
+
+	if (n<1 || n>DOM_MAXVERTICES || src<1 || src>n) {
+		replyError (job->c, DOM_EGRAPH, request.id, "bad vertex count or source");
+		return false;
+	}
+
+	bool known = false, nomemory = false;
+	double t = 0.0;
+	try {
+		if (!arcs) {
+			grow (ws.arcs, ws.arcsints, 2*(size_t)m + 2);
+			arcs = ws.arcs;
+			m = SeriesLoader::parseArcText (job->payload, reverse, m, arcs);
+		}
+		for (int i=0; i<2*m; i++) {
+			if (arcs[i]<1 || arcs[i]>n) {
+				replyError (job->c, DOM_EGRAPH, request.id, "arc out of range");
+				return false;
+			}
+		}
+		grow (ws.storage, ws.storagebytes, DominatorGraph::getStorageSize (n, m));
+		ws.g.buildGraph (n, m, src, arcs, simplify, ws.storage, false);
+		grow (ws.idom, ws.idomints, (size_t)n+1);
+	} catch (std::bad_alloc &) {
+		nomemory = true;
+	}
+
+	if (!nomemory) {
+		MemArena scratch; //empty: frees what a method cut short leaves behind
+		MemArena *previous = MemPolicy::setArena (&scratch);
+		RFWTimer timer(true);
+		try {
+			known = compute (&ws.g, request.method[0] ? request.method : defaultmethod, ws.idom);
+		} catch (std::bad_alloc &) {
+			nomemory = true;
+		}
+		t = timer.getTime();
+		MemPolicy::setArena (previous);
+	}
+	if (nomemory) {
+		replyError (job->c, DOM_EGRAPH, request.id, "out of memory");
+		return false;
+	}
+	if (!known) {
+		replyError (job->c, DOM_EMETHOD, request.id, "unknown method");
+		return false;
+	}
+	ws.idom[0] = 0;
+	reply (job->c, DOM_OK, request.id, n, ws.idom, ((size_t)n+1)*sizeof(int));
+
+	std::lock_guard<std::mutex> guard (statslock);
+	nrequests++;
+	nvertices += n;
+	narcs += ws.g.getNArcs();
+	tcompute += t;
+	latency.add (job->arrival.getTime());
+	return true;
+}
+
+void DominatorServer::worker() {
+	Workspace ws;
+	DomThread::setTeam (team);
+	while (1) {
+		Job *job;
+		{
+			std::unique_lock<std::mutex> guard (lock);
+			while (jobs.empty() && !readersdone) jobready.wait (guard);
+			if (jobs.empty()) break;
+			job = jobs.front();
+			jobs.pop_front();
+			jobspace.notify_one();
+		}
+		process (job, ws);
+		Connection *c = job->c;
+		free (job->payload);
+		delete job;
+		std::lock_guard<std::mutex> guard (c->lock);
+		if (--c->pending==0) c->idle.notify_all();
+	}
+}
+
+
+/*------------------------------------------------------------
+ | accepts connections until a shutdown request; finished 
+ | connection threads are reaped as new connections arrive
+ *-----------------------------------------------------------*/
+
+bool DominatorServer::run() {
+	struct sockaddr_un address;
+	memset (&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen (path) >= sizeof(address.sun_path)) {
+		fprintf (stderr, "Error: socket path too long.\n");
+		return false;
+	}
+	strcpy (address.sun_path, path);
+
+	//replace a socket left by an earlier server, but nothing else
+	struct stat st;
+	if (lstat (path, &st)==0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			fprintf (stderr, "Error: \"%s\" exists and is not a socket.\n", path);
+			return false;
+		}
+		unlink (path);
+	}
+	listenfd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (listenfd<0 || bind (listenfd, (struct sockaddr *)&address, sizeof(address))!=0 || listen (listenfd, 64)!=0) {
+		fprintf (stderr, "Error: cannot listen on \"%s\".\n", path);
+		if (listenfd>=0) close (listenfd);
+		return false;
+	}
+	fprintf (stderr, "Serving on \"%s\" with %d workers.\n", path, nworkers);
+	MemPolicy::setThrow (true); //a graph too large for memory gets an error reply
+
+	DomThread *workers = new DomThread [nworkers];
+	for (int i=0; i<nworkers; i++) workers[i].start (runWorker, this);
+
+	std::vector<Connection *> connections;
+	while (!stopping) {
+		struct pollfd p;
+		p.fd = listenfd;
+		p.events = POLLIN;
+		if (poll (&p, 1, 100)<=0) continue; //timeout: check whether to stop
+		int fd = accept (listenfd, NULL, NULL);
+		if (fd<0) continue;
+
+		size_t k = 0;
+		for (size_t i=0; i<connections.size(); i++) {
+			if (connections[i]->done) delete connections[i]; //joins
+			else connections[k++] = connections[i];
+		}
+		connections.resize (k);
+
+		Connection *c = new Connection;
+		c->server = this;
+		c->fd = fd;
+		c->pending = 0;
+		c->done = false;
+		{
+			std::lock_guard<std::mutex> guard (statslock);
+			nconnections++;
+			nactive++;
+		}
+		connections.push_back (c);
+		c->thread.start (runConnection, c);
+	}
+	close (listenfd);
+	unlink (path);
+
+	//no more requests: readers see end-of-file, then drain their replies
+	for (size_t i=0; i<connections.size(); i++) {
+		if (!connections[i]->done) shutdown (connections[i]->fd, SHUT_RD);
+	}
+	for (size_t i=0; i<connections.size(); i++) delete connections[i];
+	{
+		std::lock_guard<std::mutex> guard (lock);
+		readersdone = true;
+		jobready.notify_all();
+	}
+	delete [] workers; //joins
+	return true;
+}
+
+#else
+
+bool DominatorServer::run() {
+	fprintf (stderr, "Error: the server needs Unix sockets.\n");
+	return false;
+}
+
+#endif
+
+
+/*-------------------------------------------------------------------
+ | counters; the latency distribution restarts after every output
+ *------------------------------------------------------------------*/
+
+void DominatorServer::output (FILE *file) {
+	std::lock_guard<std::mutex> guard (statslock);
+	double t = uptime.getTime();
+	fprintf (file, "serverworkers %d\n", nworkers);
+	fprintf (file, "serveruptime %.6f\n", t);
+	fprintf (file, "serverconnections %d\n", nconnections);
+	fprintf (file, "serveractive %d\n", nactive);
+	fprintf (file, "serverrequests %lld\n", nrequests);
+	fprintf (file, "servererrors %lld\n", nerrors);
+	fprintf (file, "serververtices %lld\n", nvertices);
+	fprintf (file, "serverarcs %lld\n", narcs);
+	fprintf (file, "serverbytesin %lld\n", bytesin);
+	fprintf (file, "serverbytesout %lld\n", bytesout);
+	fprintf (file, "servercomputetime %.6f\n", tcompute);
+	fprintf (file, "serverrequestspersec %.4f\n", t>0 ? (double)nrequests/t : 0.0);
+	latency.summarize();
+	latency.output (file, "latency");
+	latency.clear();
+}
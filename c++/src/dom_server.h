@@ -0,0 +1,89 @@
+/**********************************************************
+ *
+ * DominatorServer
+ * - long-running service over a local Unix socket (see 
+ *   dom_protocol.h for the wire format)
+ * - one thread per connection reads requests and queues 
+ *   them (bounded); a pool of worker threads computes the
+ *   idoms and writes the replies, so a client may pipeline
+ *   requests and several clients are served concurrently
+ * - every worker keeps a warm workspace (graph storage, 
+ *   arc and idom buffers) that only grows, so steady-state
+ *   requests allocate nothing but the algorithms' scratch
+ * - requests are sized before anything is allocated for
+ *   them (n and m against DOM_MAXVERTICES and the payload),
+ *   and allocation failures throw: a graph the server has
+ *   no memory for gets an error reply (its scratch is freed)
+ *   instead of ending the process
+ * - counters (requests, errors, vertices, arcs, bytes, 
+ *   throughput) and the latency distribution (from the
+ *   arrival of a request to its reply; reset by each stats
+ *   request) are returned by DOM_STATS requests
+ * - runs until a DOM_SHUTDOWN request; pending requests are
+ *   answered first
+ * - run() removes a stale socket at the path before binding,
+ *   but fails if the path is anything other than a socket
+ * - Unix-only (run() fails elsewhere)
+ *
+ **********************************************************/
+
+#ifndef dom_server_h
+#define dom_server_h
+
+#include "dgraph.h"
+#include "bench_stats.h"
+#include "rfw_timer.h"
+#include <stdio.h>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+class DominatorServer {
+	public:
+		//runs the named method from g's source; false if there is no such method
+		typedef bool (*ComputeFunction) (DominatorGraph *g, const char *method, int *idom);
+
+	private:
+		struct Job;
+		struct Connection;
+		struct Workspace;
+
+		const char *path;
+		int nworkers;
+		int team;        //OpenMP threads of each worker
+		size_t maxjobs;  //queue bound (readers block beyond it)
+		const char *defaultmethod;
+		ComputeFunction compute;
+		int listenfd;
+		volatile bool stopping;
+
+		std::mutex lock; //protects the queue and the flags below
+		std::condition_variable jobready, jobspace;
+		std::deque<Job *> jobs;
+		bool readersdone; //no more jobs will come
+
+		std::mutex statslock; //protects the counters
+		long long nrequests, nerrors, nvertices, narcs, bytesin, bytesout;
+		int nconnections, nactive;
+		double tcompute;
+		BenchStats latency; //since the last stats request
+		RFWTimer uptime;
+
+		void worker();
+		void connection (Connection *c);
+		bool process (Job *job, Workspace &ws);
+		void reply (Connection *c, unsigned int status, unsigned int id, int n, const void *payload, size_t bytes);
+		void replyError (Connection *c, unsigned int status, unsigned int id, const char *message);
+		char *statsText (size_t &bytes);
+		static void runWorker (void *self);
+		static void runConnection (void *arg);
+
+	public:
+		DominatorServer (const char *_path, int _nworkers, const char *_defaultmethod, ComputeFunction _compute);
+
+		bool run(); //false if the socket cannot be set up
+		void output (FILE *file); //"name value" lines
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*************************************
+ *
+ * DomThread (see dom_thread.h)
+ *
+ *************************************/
+
+#include "dom_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef WIN32
+#include <system_error>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef WIN32
+void *DomThread::main (void *self) {
+	DomThread *t = (DomThread *)self;
+	t->function (t->argument);
+	return NULL;
+}
+#endif
+
+void DomThread::start (Function _function, void *_argument) {
+	if (!tryStart (_function, _argument)) {
+		fprintf (stderr, "Error creating thread.\n");
+		exit(-1);
+	}
+}
+
+bool DomThread::tryStart (Function _function, void *_argument) {
+	function = _function;
+	argument = _argument;
+#ifdef WIN32
+	try {
+		thread = std::thread (function, argument);
+	} catch (std::system_error &) {
+		return false;
+	}
+#else
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr, STACKSIZE);
+	int status = pthread_create (&thread, &attr, main, this);
+	pthread_attr_destroy (&attr);
+	if (status!=0) return false;
+#endif
+	started = true;
+	return true;
+}
+
+void DomThread::join() {
+	if (!started) return;
+#ifdef WIN32
+	thread.join();
+#else
+	pthread_join (thread, NULL);
+#endif
+	started = false;
+}
+
+int DomThread::teamSize (int k) {
+#ifdef _OPENMP
+	int t = omp_get_max_threads() / ((k<1) ? 1 : k);
+	return (t<1) ? 1 : t;
+#else
+	return 1;
+#endif
+}
+
+void DomThread::setTeam (int nthreads) {
+#ifdef _OPENMP
+	omp_set_num_threads ((nthreads<1) ? 1 : nthreads);
+#endif
+}
@@ -0,0 +1,54 @@
+/**********************************************************
+ *
+ * DomThread
+ * - a thread that runs function(argument) once
+ * - outside Windows the thread gets a large stack (reserved,
+ *   not committed): some methods use deep recursion, and 
+ *   threads otherwise get a small default stack (2 MB when
+ *   the stack limit is unlimited)
+ * - k threads that run methods side by side should call
+ *   setTeam(teamSize(k)): OpenMP regions they start (bfsdo,
+ *   the tree levels) would otherwise each use every core
+ *
+ **********************************************************/
+
+#ifndef dom_thread_h
+#define dom_thread_h
+
+#ifdef WIN32
+#include <thread>
+#else
+#include <pthread.h>
+#endif
+
+class DomThread {
+	public:
+		typedef void (*Function) (void *argument);
+		static const size_t STACKSIZE = (size_t)1 << 30;
+
+	private:
+		Function function;
+		void *argument;
+		bool started;
+#ifdef WIN32
+		std::thread thread;
+#else
+		pthread_t thread;
+		static void *main (void *self);
+#endif
+
+	public:
+		DomThread() : function(NULL), argument(NULL), started(false) {}
+		~DomThread() {join();}
+
+		void start (Function _function, void *_argument); //exits on failure
+		bool tryStart (Function _function, void *_argument); //false on failure
+		void join(); //no-op unless started
+
+		//share of the caller's OpenMP threads for each of k threads
+		static int teamSize (int k);
+		//sets the team size of OpenMP regions started by the calling thread
+		static void setTeam (int nthreads);
+};
+
+#endif
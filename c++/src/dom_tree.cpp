@@ -0,0 +1,322 @@
+/*************************************
+ *
+ * DominatorTree (see dom_tree.h)
+ *
+ *************************************/
+
+#include "dom_tree.h"
+#include "mem_policy.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+DominatorTree::DominatorTree() {
+	memset (&t, 0, sizeof(t));
+	height = 0;
+	parallel = false;
+}
+
+DominatorTree::~DominatorTree() {clear();}
+
+void DominatorTree::clear() {
+	freeView (t);
+	height = 0;
+}
+
+void DominatorTree::freeView (View &view) {
+	mpDelete (view.first);
+	mpDelete (view.children);
+	mpDelete (view.parent);
+	mpDelete (view.pre);
+	mpDelete (view.order);
+	mpDelete (view.depth);
+	mpDelete (view.size);
+	memset (&view, 0, sizeof(view));
+}
+
+DominatorTree::View DominatorTree::release() {
+	View view = t;
+	memset (&t, 0, sizeof(t));
+	height = 0;
+	return view;
+}
+
+
+/*-----------------------------------------------------------
+ | children CSR by counting sort on the parent (so that the
+ | children of every vertex come out in increasing order)
+ *----------------------------------------------------------*/
+
+void DominatorTree::buildChildren (const int *idom) {
+	int n = t.n;
+	int v;
+	int *first = t.first;
+	int *cursor = t.depth; //temporarily
+
+	for (v=0; v<=n+1; v++) first[v] = 0;
+	t.count = 0;
+	t.parent[0] = 0;
+	for (v=1; v<=n; v++) {
+		int p = idom[v];
+		if (p!=0) t.count++;
+		if (p==v) p = 0; //the root
+		t.parent[v] = p;
+		if (p) first[p+1]++;
+	}
+	for (v=1; v<=n+1; v++) first[v] += first[v-1];
+	for (v=0; v<=n; v++) cursor[v] = first[v];
+	for (v=1; v<=n; v++) {
+		int p = t.parent[v];
+		if (p) t.children[cursor[p]++] = v;
+	}
+}
+
+
+/*-------------------------------------------------------------------
+ | BFS over the tree (order doubles as the queue), then sizes bottom
+ | up and preorder numbers top down, one level at a time; with par, 
+ | wide levels are split among threads (vertices in the same level
+ | write disjoint entries); narrow levels never enter a parallel 
+ | region, which would cost more than a chain-like level's work
+ *------------------------------------------------------------------*/
+
+//appends the children of v to the queue, starting at position k
+static inline void enqueueChildren (DominatorTree::View &t, int *queue, int v, int k) {
+	int d = t.depth[v] + 1;
+	for (int c=t.first[v]; c<t.first[v+1]; c++) {
+		int w = t.children[c];
+		queue[k++] = w;
+		t.depth[w] = d;
+	}
+}
+
+static inline void sumChildren (DominatorTree::View &t, int v) {
+	int s = 1;
+	for (int c=t.first[v]; c<t.first[v+1]; c++) s += t.size[t.children[c]];
+	t.size[v] = s;
+}
+
+//the children of v follow v, each after its older siblings' subtrees
+static inline void numberChildren (DominatorTree::View &t, int v) {
+	int p = t.pre[v] + 1;
+	for (int c=t.first[v]; c<t.first[v+1]; c++) {
+		int w = t.children[c];
+		t.pre[w] = p;
+		p += t.size[w];
+	}
+}
+
+void DominatorTree::buildLevels (bool par) {
+	const int MINLEVEL = 1024; //narrower levels are processed by one thread
+	int n = t.n;
+	int *queue = t.order;   //BFS order; becomes the preorder at the end
+	int *offset = t.size;   //temporarily, position of the children of queue[i]
+	int *level = new int [t.count+2]; //level k is queue[level[k]..level[k+1]-1]
+	int nlevels = 0;
+	int v, i;
+
+	#pragma omp parallel for if(par) schedule(static)
+	for (v=0; v<=n; v++) {
+		t.depth[v] = -1;
+		t.pre[v] = 0;
+	}
+
+	//BFS: the next level is the concatenation of the children of this one
+	queue[0] = t.root;
+	t.depth[t.root] = 0;
+	level[0] = 0;
+	int lo = 0, hi = 1;
+	while (lo<hi) {
+		level[++nlevels] = hi;
+		int pos = hi;
+		for (i=lo; i<hi; i++) {
+			offset[i] = pos;
+			pos += t.first[queue[i]+1] - t.first[queue[i]];
+		}
+		if (par && hi-lo>=MINLEVEL) {
+			#pragma omp parallel for schedule(static)
+			for (i=lo; i<hi; i++) enqueueChildren (t, queue, queue[i], offset[i]);
+		} else {
+			for (i=lo; i<hi; i++) enqueueChildren (t, queue, queue[i], offset[i]);
+		}
+		lo = hi;
+		hi = pos;
+	}
+	height = nlevels - 1;
+
+	//subtree sizes, deepest level first
+	#pragma omp parallel for if(par) schedule(static)
+	for (v=0; v<=n; v++) t.size[v] = 0;
+	for (int k=nlevels-1; k>=0; k--) {
+		if (par && level[k+1]-level[k]>=MINLEVEL) {
+			#pragma omp parallel for schedule(static)
+			for (i=level[k]; i<level[k+1]; i++) sumChildren (t, queue[i]);
+		} else {
+			for (i=level[k]; i<level[k+1]; i++) sumChildren (t, queue[i]);
+		}
+	}
+
+	//preorder, top down
+	t.pre[t.root] = 1;
+	for (int k=0; k<nlevels; k++) {
+		if (par && level[k+1]-level[k]>=MINLEVEL) {
+			#pragma omp parallel for schedule(static)
+			for (i=level[k]; i<level[k+1]; i++) numberChildren (t, queue[i]);
+		} else {
+			for (i=level[k]; i<level[k+1]; i++) numberChildren (t, queue[i]);
+		}
+	}
+	delete [] level;
+
+	//the queue is no longer needed
+	t.order[0] = 0;
+	#pragma omp parallel for if(par) schedule(static)
+	for (v=1; v<=n; v++) {
+		if (t.pre[v]) t.order[t.pre[v]] = v;
+	}
+}
+
+
+void DominatorTree::build (int n, const int *idom, int root, bool _parallel) {
+	clear();
+	t.n = n;
+	t.root = root;
+	t.first = mpNew<int> (n+2);
+	t.children = mpNew<int> (n>1 ? n-1 : 1);
+	t.parent = mpNew<int> (n+1);
+	t.pre = mpNew<int> (n+1);
+	t.order = mpNew<int> (n+1);
+	t.depth = mpNew<int> (n+1);
+	t.size = mpNew<int> (n+1);
+
+#ifdef _OPENMP
+	parallel = _parallel && n>=PARALLEL_MIN;
+#else
+	parallel = false;
+#endif
+	buildChildren (idom);
+	buildLevels (parallel);
+}
+
+
+void DominatorTree::output (FILE *file) const {
+	long long leaves = 0;
+	for (int v=1; v<=t.n; v++) {
+		if (t.pre[v] && t.first[v+1]==t.first[v]) leaves++;
+	}
+	fprintf (file, "treereachable %d\n", t.count);
+	fprintf (file, "treeheight %d\n", height);
+	fprintf (file, "treeleaves %lld\n", leaves);
+	fprintf (file, "treeparallel %d\n", (int)parallel);
+}
+
+
+/*------------------------------------------------------------------
+ | retained[v] = sum of the weights in preorder positions pre[v]..
+ | pre[v]+size[v]-1; the prefix sum is computed in blocks (one per
+ | thread) when parallel
+ *-----------------------------------------------------------------*/
+
+void DominatorTree::getRetained (const long long *weight, long long *retained, bool par) const {
+	int n = t.n;
+	int count = t.count;
+	long long *sum = mpNew<long long> (count+1); //sum[i]: weights in positions 1..i
+	int v;
+#ifdef _OPENMP
+	par = par && n>=PARALLEL_MIN;
+#else
+	par = false;
+#endif
+
+	sum[0] = 0;
+	if (!par) {
+		for (int i=1; i<=count; i++) {
+			sum[i] = sum[i-1] + (weight ? weight[t.order[i]] : 1);
+		}
+	}
+#ifdef _OPENMP
+	else {
+		long long *partial = new long long [omp_get_max_threads()+1]; //block totals
+		#pragma omp parallel
+		{
+			int id = omp_get_thread_num();
+			int k = omp_get_num_threads();
+			int lo = 1 + (int)((long long)count * id / k);
+			int hi = 1 + (int)((long long)count * (id+1) / k);
+			long long s = 0;
+			for (int i=lo; i<hi; i++) {
+				s += (weight ? weight[t.order[i]] : 1);
+				sum[i] = s;
+			}
+			partial[id+1] = s;
+			#pragma omp barrier
+			#pragma omp single
+			{
+				partial[0] = 0;
+				for (int j=1; j<=k; j++) partial[j] += partial[j-1];
+			}
+			long long base = partial[id];
+			for (int i=lo; i<hi; i++) sum[i] += base;
+		}
+		delete [] partial;
+	}
+#endif
+
+	#pragma omp parallel for if(par) schedule(static)
+	for (v=0; v<=n; v++) {
+		int p = t.pre[v];
+		retained[v] = p ? sum[p+t.size[v]-1] - sum[p-1] : 0;
+	}
+	mpDelete (sum);
+}
+
+
+/*-----------------------------------------------------------
+ | top k with a min-heap of k entries: O(n log k); the heap
+ | is sorted (largest first) at the end
+ *----------------------------------------------------------*/
+
+static inline bool smaller (const long long *value, int a, int b) {
+	return value[a]<value[b] || (value[a]==value[b] && a>b);
+}
+
+static void siftDown (const long long *value, int *heap, int size, int i) {
+	int x = heap[i];
+	while (1) {
+		int c = 2*i + 1;
+		if (c>=size) break;
+		if (c+1<size && smaller (value, heap[c+1], heap[c])) c++;
+		if (!smaller (value, heap[c], x)) break;
+		heap[i] = heap[c];
+		i = c;
+	}
+	heap[i] = x;
+}
+
+int DominatorTree::getTopK (const long long *value, int k, int *top) const {
+	int size = 0;
+	if (k<=0) return 0;
+	for (int v=1; v<=t.n; v++) {
+		if (!t.pre[v]) continue;
+		if (size<k) {
+			//append and sift up
+			int i = size++;
+			while (i>0 && smaller (value, v, top[(i-1)/2])) {
+				top[i] = top[(i-1)/2];
+				i = (i-1)/2;
+			}
+			top[i] = v;
+		} else if (smaller (value, top[0], v)) {
+			top[0] = v;
+			siftDown (value, top, size, 0);
+		}
+	}
+
+	//heapsort: repeatedly move the smallest to the end
+	for (int s=size-1; s>0; s--) {
+		int x = top[0]; top[0] = top[s]; top[s] = x;
+		siftDown (value, top, s, 0);
+	}
+	return size;
+}
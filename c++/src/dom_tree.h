@@ -0,0 +1,97 @@
+/**********************************************************
+ *
+ * DominatorTree
+ * - the dominator tree materialized from an idom array in 
+ *   linear time, as flat int arrays indexed by vertex:
+ *   - children CSR: the children of v (in increasing order)
+ *     are children[first[v]..first[v+1]-1]
+ *   - parent: idom, except that the root and unreachable 
+ *     vertices have parent 0
+ *   - pre: preorder number (1..count; 0 if unreachable) and
+ *     order: the vertex with each preorder number
+ *   - depth: number of edges from the root (-1 if unreachable)
+ *   - size: vertices in the subtree (0 if unreachable)
+ * - u dominates v iff pre[u] <= pre[v] < pre[u] + size[u]
+ * - the tree is traversed level by level (BFS); the parallel
+ *   build (OpenMP) splits the wide levels among threads and 
+ *   is used only for trees with at least PARALLEL_MIN vertices
+ * - retained sizes: total weight of each subtree, from a
+ *   prefix sum of the weights in preorder (a subtree is a
+ *   contiguous range of it); the k largest are selected 
+ *   with a heap, without sorting all vertices
+ * - getView() lends the arrays (zero-copy; valid while the
+ *   tree is unchanged); release() hands them over for good
+ *   (free with freeView)
+ *
+ **********************************************************/
+
+#ifndef dom_tree_h
+#define dom_tree_h
+
+#include <stdio.h>
+
+class DominatorTree {
+	public:
+		static const int PARALLEL_MIN = 1<<18;
+
+		typedef struct {
+			int n;         //vertices (arrays are indexed 0..n)
+			int count;     //reachable vertices
+			int root;
+			int *first;    //n+2 entries
+			int *children; //count-1 entries (at least one)
+			int *parent;
+			int *pre;
+			int *order;    //order[1..count]
+			int *depth;
+			int *size;
+		} View;
+
+	private:
+		View t;
+		int height; //maximum depth
+		bool parallel; //was the last build parallel?
+
+		void buildChildren (const int *idom);
+		void buildLevels (bool par);
+		void clear();
+
+	public:
+		DominatorTree();
+		~DominatorTree();
+
+		//idom[1..n] as produced by the algorithms (idom[root]=root)
+		void build (int n, const int *idom, int root, bool parallel = false);
+
+		inline int getNVertices() const {return t.n;}
+		inline int getNReachable() const {return t.count;}
+		inline int getRoot() const {return t.root;}
+		inline int getHeight() const {return height;}
+		inline bool wasParallel() const {return parallel;}
+
+		inline int getParent (int v) const {return t.parent[v];}
+		inline int getPre (int v) const {return t.pre[v];}
+		inline int getVertex (int i) const {return t.order[i];}
+		inline int getDepth (int v) const {return t.depth[v];}
+		inline int getSize (int v) const {return t.size[v];}
+		inline int getNChildren (int v) const {return t.first[v+1] - t.first[v];}
+		inline const int *getChildren (int v) const {return &t.children[t.first[v]];}
+		inline bool dominates (int u, int v) const {
+			return t.pre[u] && t.pre[v] && t.pre[u]<=t.pre[v] && t.pre[v]<t.pre[u]+t.size[u];
+		}
+
+		//weight[1..n] (NULL: all 1); retained[0..n] (0 if unreachable)
+		void getRetained (const long long *weight, long long *retained, bool parallel = false) const;
+
+		//the (at most) k reachable vertices with largest value, largest
+		//first (ties: smaller vertex first); returns how many
+		int getTopK (const long long *value, int k, int *top) const;
+
+		const View &getView() const {return t;}
+		View release(); //the tree becomes empty
+		static void freeView (View &view);
+
+		void output (FILE *file) const; //"name value" lines
+};
+
+#endif
@@ -0,0 +1,301 @@
+/* Client of the dominator server (dom <socket> -server). Sends one
+   graph (a DIMACS file) or every graph of a series (a file listing
+   DIMACS files), as DIMACS text or, with -binary, as a binary list
+   of arcs; with -depth d, keeps up to d requests in flight on one 
+   connection. Prints "key value" lines: requests, errors, time, 
+   throughput, and the latency distribution seen by the client.
+   Can also fetch the server's counters (-stats) and stop it 
+   (-shutdown). */
+
+#include "dom_protocol.h"
+#include "bench_stats.h"
+#include "rfw_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+void printUsage (const char *command) {
+	fprintf (stderr, "Usage: %s <socket> <graph or series> [-binary] [-method <method>] [-reverse] [-simplify]\n", command);
+	fprintf (stderr, "       [-repeat <k>] [-depth <d>] [-idomfile <file>] [-stats] [-shutdown]\n");
+	fprintf (stderr, "       %s <socket> -stats\n", command);
+	fprintf (stderr, "       %s <socket> -shutdown\n", command);
+	exit(-1);
+}
+
+void fatal (const char *msg) {
+	fprintf (stderr, "ERROR: %s.\n", msg);
+	exit(-1);
+}
+
+
+/*-------------------------------------------
+ | a graph, ready to be sent (payload only)
+ *------------------------------------------*/
+
+typedef struct {
+	char *name;
+	char *payload;
+	unsigned int length;
+	int n, source; //binary payloads only
+} Graph;
+
+char *readFile (const char *filename, unsigned int &length) {
+	FILE *input = fopen (filename, "rb");
+	if (!input) {
+		fprintf (stderr, "Error opening file \"%s\".\n", filename);
+		exit(-1);
+	}
+	fseek (input, 0, SEEK_END);
+	long size = ftell (input);
+	fseek (input, 0, SEEK_SET);
+	char *data = (char *)malloc (size+1);
+	length = (unsigned int)fread (data, 1, size, input);
+	data[length] = 0;
+	fclose (input);
+	return data;
+}
+
+//DIMACS text -> pairs of ints (n and source from the 'p' line; sink if reverse)
+void toBinary (Graph &g, bool reverse) {
+	const char *s = g.payload;
+	int m = 0, snk = 0;
+	int *arcs = NULL;
+	int k = 0;
+	while (*s) {
+		//strtol rather than sscanf, which may scan the whole rest of the text
+		char *end;
+		if (*s=='p') {
+			g.n = (int)strtol (s+1, &end, 10);
+			m = (int)strtol (end, &end, 10);
+			g.source = (int)strtol (end, &end, 10);
+			snk = (int)strtol (end, &end, 10);
+			if (end==s+1 || m<0) fatal ("bad 'p' line");
+			if (reverse) g.source = snk; //the server reverses the arcs
+			arcs = (int *)malloc ((2*(size_t)m + 2) * sizeof(int));
+		} else if (*s=='a' && arcs && k<m) {
+			arcs[2*k] = (int)strtol (s+1, &end, 10);
+			arcs[2*k+1] = (int)strtol (end, &end, 10);
+			k++;
+		}
+		while (*s && *s!='\n') s++;
+		if (*s) s++;
+	}
+	if (!arcs) fatal ("no 'p' line");
+	free (g.payload);
+	g.payload = (char *)arcs;
+	g.length = 2 * k * sizeof(int);
+}
+
+
+/*------------------------------
+ | connection and I/O helpers
+ *-----------------------------*/
+
+int connectTo (const char *path) {
+	struct sockaddr_un address;
+	memset (&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen (path) >= sizeof(address.sun_path)) fatal ("socket path too long");
+	strcpy (address.sun_path, path);
+	int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd<0 || connect (fd, (struct sockaddr *)&address, sizeof(address))!=0) fatal ("cannot connect to the server");
+	return fd;
+}
+
+void readFull (int fd, void *data, size_t bytes) {
+	char *p = (char *)data;
+	while (bytes) {
+		ssize_t k = recv (fd, p, bytes, 0);
+		if (k<=0) fatal ("connection closed by the server");
+		p += k;
+		bytes -= k;
+	}
+}
+
+void writeFull (int fd, const void *data, size_t bytes) {
+	const char *p = (const char *)data;
+	while (bytes) {
+		ssize_t k = send (fd, p, bytes, MSG_NOSIGNAL);
+		if (k<=0) fatal ("connection closed by the server");
+		p += k;
+		bytes -= k;
+	}
+}
+
+void sendRequest (int fd, unsigned int type, unsigned int id, unsigned int flags, const char *method, const Graph *g) {
+	DomRequest r;
+	memset (&r, 0, sizeof(r));
+	r.magic = DOM_REQUEST_MAGIC;
+	r.type = type;
+	r.flags = flags;
+	r.id = id;
+	if (g) {
+		r.n = g->n;
+		r.source = g->source;
+		r.length = g->length;
+	}
+	if (method) strncpy (r.method, method, sizeof(r.method)-1);
+	writeFull (fd, &r, sizeof(r));
+	if (g) writeFull (fd, g->payload, g->length);
+}
+
+//reads a reply; its payload goes to a buffer that grows as needed
+DomReply readReply (int fd, char *&buffer, size_t &size) {
+	DomReply r;
+	readFull (fd, &r, sizeof(r));
+	if (r.magic!=DOM_REPLY_MAGIC) fatal ("bad reply header");
+	if (r.length + 1 > size) {
+		size = r.length + 1;
+		buffer = (char *)realloc (buffer, size);
+	}
+	readFull (fd, buffer, r.length);
+	buffer[r.length] = 0;
+	return r;
+}
+
+//requests without a graph: print the text of the reply
+void simpleRequest (const char *path, unsigned int type) {
+	int fd = connectTo (path);
+	char *buffer = NULL;
+	size_t size = 0;
+	sendRequest (fd, type, 0, 0, NULL, NULL);
+	readReply (fd, buffer, size);
+	fputs (buffer, stdout);
+	free (buffer);
+	close (fd);
+}
+
+
+int main (int argc, char *argv[]) {
+	if (argc<3) printUsage (argv[0]);
+	const char *path = argv[1];
+	if (strcmp (argv[2], "-stats")==0) {simpleRequest (path, DOM_STATS); return 0;}
+	if (strcmp (argv[2], "-shutdown")==0) {simpleRequest (path, DOM_SHUTDOWN); return 0;}
+
+	const char *input = argv[2];
+	bool binary = false, reverse = false, simplify = false, stats = false, stop = false;
+	const char *method = NULL;
+	int repeat = 1, depth = 8;
+	FILE *idomfile = NULL;
+	for (int i=3; i<argc; i++) {
+		if (strcmp (argv[i], "-binary")==0) binary = true;
+		else if (strcmp (argv[i], "-reverse")==0) reverse = true;
+		else if (strcmp (argv[i], "-simplify")==0) simplify = true;
+		else if (strcmp (argv[i], "-stats")==0) stats = true;
+		else if (strcmp (argv[i], "-shutdown")==0) stop = true;
+		else if (i+1<argc && strcmp (argv[i], "-method")==0) method = argv[++i];
+		else if (i+1<argc && strcmp (argv[i], "-repeat")==0) repeat = atoi (argv[++i]);
+		else if (i+1<argc && strcmp (argv[i], "-depth")==0) depth = atoi (argv[++i]);
+		else if (i+1<argc && strcmp (argv[i], "-idomfile")==0) {
+			idomfile = fopen (argv[++i], "w");
+			if (!idomfile) fatal ("cannot open file for writing");
+		} else printUsage (argv[0]);
+	}
+	if (repeat<1) repeat = 1;
+	if (depth<1) depth = 1;
+
+	//graphs: one file, or every file in a series
+	int count = 0, capacity = 16;
+	Graph *graphs = (Graph *)malloc (capacity * sizeof(Graph));
+	int len = strlen (input);
+	bool series = (len>=7 && strcmp (&input[len-7], ".series")==0);
+	FILE *list = series ? fopen (input, "r") : NULL;
+	if (series && !list) fatal ("cannot open series");
+	char name[1024];
+	while (series ? (fscanf (list, "%1023s", name)==1) : (count==0)) {
+		if (!series) {strncpy (name, input, sizeof(name)-1); name[sizeof(name)-1] = 0;}
+		if (count==capacity) {
+			capacity *= 2;
+			graphs = (Graph *)realloc (graphs, capacity * sizeof(Graph));
+		}
+		Graph &g = graphs[count++];
+		g.name = strdup (name);
+		g.payload = readFile (name, g.length);
+		g.n = g.source = 0;
+		if (binary) toBinary (g, reverse);
+	}
+	if (list) fclose (list);
+
+	/*----------------------------------------------------------------
+	 | requests go out in order, with at most 'depth' of them pending;
+	 | idoms of the first round are kept for -idomfile
+	 *---------------------------------------------------------------*/
+	int fd = connectTo (path);
+	unsigned int type = binary ? DOM_ARCS : DOM_DIMACS;
+	unsigned int flags = (reverse ? DOM_REVERSE : 0) | (simplify ? DOM_SIMPLIFY : 0);
+	int total = count * repeat;
+	RFWTimer *sent = new RFWTimer [total];
+	int **idoms = (int **)calloc (count, sizeof(int *));
+	int *nidoms = (int *)calloc (count, sizeof(int));
+	char *buffer = NULL;
+	size_t size = 0;
+	BenchStats latency;
+	int next = 0, done = 0, errors = 0;
+	long long vertices = 0;
+
+	RFWTimer timer(true);
+	while (done<total) {
+		while (next<total && next-done<depth) {
+			sent[next].start();
+			sendRequest (fd, type, next, flags, method, &graphs[next % count]);
+			next++;
+		}
+		DomReply r = readReply (fd, buffer, size);
+		if (r.id>=(unsigned int)total) fatal ("reply to an unknown request");
+		latency.add (sent[r.id].getTime());
+		done++;
+		if (r.status!=DOM_OK) {
+			errors++;
+			fprintf (stderr, "Request %u (%s) failed: %s\n", r.id, graphs[r.id % count].name, buffer);
+			continue;
+		}
+		vertices += r.n;
+		if (idomfile && r.id<(unsigned int)count) {
+			idoms[r.id] = (int *)malloc (r.length);
+			memcpy (idoms[r.id], buffer, r.length);
+			nidoms[r.id] = r.n;
+		}
+	}
+	double t = timer.getTime();
+	close (fd);
+
+	if (idomfile) {
+		for (int i=0; i<count; i++) {
+			if (!idoms[i]) continue;
+			if (count>1) fprintf (idomfile, "c %s\n", graphs[i].name);
+			for (int v=1; v<=nidoms[i]; v++) fprintf (idomfile, "%d %d\n", v, idoms[i][v]);
+		}
+		fclose (idomfile);
+	}
+
+	fprintf (stdout, "input %s\n", input);
+	fprintf (stdout, "graphs %d\n", count);
+	fprintf (stdout, "repeat %d\n", repeat);
+	fprintf (stdout, "depth %d\n", depth);
+	fprintf (stdout, "binary %d\n", (int)binary);
+	fprintf (stdout, "requests %d\n", total);
+	fprintf (stdout, "errors %d\n", errors);
+	fprintf (stdout, "vertices %lld\n", vertices);
+	fprintf (stdout, "totaltime %.6f\n", t);
+	fprintf (stdout, "requestspersec %.4f\n", t>0 ? (double)total/t : 0.0);
+	latency.summarize();
+	latency.output (stdout, "latency");
+
+	if (stats) simpleRequest (path, DOM_STATS);
+	if (stop) simpleRequest (path, DOM_SHUTDOWN);
+
+	for (int i=0; i<count; i++) {
+		free (graphs[i].name);
+		free (graphs[i].payload);
+		free (idoms[i]);
+	}
+	free (graphs);
+	free (idoms);
+	free (nidoms);
+	free (buffer);
+	delete [] sent;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/* Embedding benchmark of libdominators: a plain C program that uses
+   only libdominators.h, as a service embedding the library would.
+   Reads one graph (a DIMACS file) or every graph of a series (a file
+   ending in ".series" that lists DIMACS files) into arc lists, then
+   measures, per graph and in total: building the library graph from
+   the arcs and from a CSR, the first (cold) computation with a fresh
+   workspace, warm computations reusing one workspace, computations
+   without a workspace, and (for the methods that have them)
+   computations on the caller's arrays with no library graph, through
+   domlib_compute_csr and domlib_compute_view. Checks that all runs
+   agree and prints "key value" lines. */
+
+#include "libdominators.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void printUsage (const char *command) {
+	fprintf (stderr, "Usage: %s <graph or series> [-method <method>] [-repeat <k>] [-reverse] [-simplify]\n", command);
+	exit(-1);
+}
+
+void fatal (const char *msg) {
+	fprintf (stderr, "ERROR: %s.\n", msg);
+	exit(-1);
+}
+
+double now (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+
+/*-------------------------------------------------------------
+ | a graph as the embedding service would hold it: arcs (the
+ | arc list) and the equivalent CSRs (first/adj: out-neighbors,
+ | ifirst/iadj: in-neighbors)
+ *------------------------------------------------------------*/
+
+typedef struct {
+	int n, m, source, sink;
+	int *arcs;
+	int *first, *adj;
+	int *ifirst, *iadj;
+} Input;
+
+//CSR of the arcs by counting sort on one end (0: tails, 1: heads)
+void buildCSR (Input *in, int end, int **first, int **adj) {
+	int *f = (int *)calloc (in->n+2, sizeof(int));
+	int *a = (int *)malloc (((size_t)in->m + 1) * sizeof(int));
+	for (int i=0; i<in->m; i++) {
+		int v = in->arcs[2*i+end];
+		if (v>=1 && v<=in->n) f[v+1]++;
+	}
+	f[1] = 0;
+	for (int v=1; v<=in->n; v++) f[v+1] += f[v];
+	int *next = (int *)malloc ((in->n+2) * sizeof(int));
+	memcpy (next, f, (in->n+2) * sizeof(int));
+	for (int i=0; i<in->m; i++) {
+		int v = in->arcs[2*i+end];
+		if (v>=1 && v<=in->n) a[next[v]++] = in->arcs[2*i+1-end];
+	}
+	free (next);
+	*first = f;
+	*adj = a;
+}
+
+int readInput (const char *filename, Input *in) {
+	FILE *file = fopen (filename, "r");
+	if (!file) return 0;
+	if (fscanf (file, "p %d %d %d %d", &in->n, &in->m, &in->source, &in->sink)!=4 || in->n<1 || in->m<0) {
+		fclose (file);
+		return 0;
+	}
+	in->arcs = (int *)malloc ((2*(size_t)in->m + 1) * sizeof(int));
+	int k = 0, a, b;
+	char line[256];
+	while (k<in->m && fgets (line, sizeof(line), file)) {
+		if (sscanf (line, "a %d %d", &a, &b)!=2) continue;
+		in->arcs[2*k] = a;
+		in->arcs[2*k+1] = b;
+		k++;
+	}
+	fclose (file);
+	in->m = k;
+
+	buildCSR (in, 0, &in->first, &in->adj);
+	buildCSR (in, 1, &in->ifirst, &in->iadj);
+	return 1;
+}
+
+void freeInput (Input *in) {
+	free (in->arcs);
+	free (in->first);
+	free (in->adj);
+	free (in->ifirst);
+	free (in->iadj);
+}
+
+//neighbor callbacks for domlib_compute_view (context: an Input)
+int outNeighbors (void *context, int v, const int **list) {
+	Input *in = (Input *)context;
+	*list = &in->adj[in->first[v]];
+	return in->first[v+1] - in->first[v];
+}
+
+int inNeighbors (void *context, int v, const int **list) {
+	Input *in = (Input *)context;
+	*list = &in->iadj[in->ifirst[v]];
+	return in->ifirst[v+1] - in->ifirst[v];
+}
+
+void check (int status, const char *what) {
+	if (status==DOMLIB_OK) return;
+	fprintf (stderr, "ERROR: %s: %s.\n", what, domlib_strerror (status));
+	exit(-1);
+}
+
+
+int main (int argc, char *argv[]) {
+	if (argc<2) printUsage (argv[0]);
+	const char *input = argv[1];
+	const char *mname = "snca";
+	int repeat = 10;
+	int flags = 0;
+	for (int i=2; i<argc; i++) {
+		if (strcmp (argv[i], "-method")==0) {
+			i++; if (i==argc) fatal ("missing method");
+			mname = argv[i];
+		} else if (strcmp (argv[i], "-repeat")==0) {
+			i++; if (i==argc) fatal ("missing repeat count");
+			repeat = atoi (argv[i]);
+			if (repeat<1) fatal ("invalid repeat count");
+		} else if (strcmp (argv[i], "-reverse")==0) {
+			flags |= DOMLIB_REVERSE;
+		} else if (strcmp (argv[i], "-simplify")==0) {
+			flags |= DOMLIB_SIMPLIFY;
+		} else printUsage (argv[0]);
+	}
+	int method = domlib_method (mname);
+	if (method<0) fatal ("unknown method");
+
+	//graphs: one file, or every file in a series
+	size_t len = strlen (input);
+	int series = (len>=7 && strcmp (&input[len-7], ".series")==0);
+	FILE *list = series ? fopen (input, "r") : NULL;
+	if (series && !list) fatal ("cannot open series");
+
+	domlib_workspace *shared;
+	check (domlib_workspace_create (&shared), "creating a workspace");
+
+	char name[1024];
+	int count = 0, ignored = 0;
+	long long vertices = 0, arcs = 0;
+	double tarcs = 0.0, tcsr = 0.0, tcold = 0.0, twarm = 0.0, tnows = 0.0;
+	double tcsrview = 0.0, tcbview = 0.0;
+	int views = 1; //does the method run on views?
+	int *idom = NULL, *ref = NULL;
+	int maxn = 0;
+	int first = 1;
+	while (series ? (fscanf (list, "%1023s", name)==1) : first) {
+		if (!series) {strncpy (name, input, sizeof(name)-1); name[sizeof(name)-1] = 0;}
+		first = 0;
+
+		Input in;
+		if (!readInput (name, &in)) {
+			if (!series) fatal ("cannot read the graph");
+			ignored++;
+			continue;
+		}
+		int source = (flags & DOMLIB_REVERSE) ? in.sink : in.source;
+		if (source<1 || source>in.n) { //graphs without a source are skipped, as in dom
+			freeInput (&in);
+			ignored++;
+			continue;
+		}
+		if (in.n>maxn) {
+			maxn = in.n;
+			idom = (int *)realloc (idom, (maxn+1) * sizeof(int));
+			ref = (int *)realloc (ref, (maxn+1) * sizeof(int));
+		}
+
+		//creation, from both representations
+		domlib_graph *g, *h;
+		double t = now();
+		check (domlib_graph_from_arcs (in.n, in.m, source, in.arcs, flags, &g), name);
+		tarcs += now() - t;
+		t = now();
+		check (domlib_graph_from_csr (in.n, source, in.first, in.adj, flags, &h), name);
+		tcsr += now() - t;
+		domlib_graph_destroy (h);
+
+		//cold: a fresh workspace
+		domlib_workspace *ws;
+		check (domlib_workspace_create (&ws), "creating a workspace");
+		t = now();
+		check (domlib_compute (g, method, ws, ref), name);
+		tcold += now() - t;
+		domlib_workspace_destroy (ws);
+
+		//warm: one workspace shared by the whole series (first call untimed)
+		check (domlib_compute (g, method, shared, idom), name);
+		t = now();
+		for (int r=0; r<repeat; r++) check (domlib_compute (g, method, shared, idom), name);
+		twarm += (now() - t) / repeat;
+		if (memcmp (idom, ref, (in.n+1) * sizeof(int))!=0) fatal ("warm and cold runs disagree");
+
+		//no workspace: scratch arrays allocated by every call
+		t = now();
+		for (int r=0; r<repeat; r++) check (domlib_compute (g, method, NULL, idom), name);
+		tnows += (now() - t) / repeat;
+		if (memcmp (idom, ref, (in.n+1) * sizeof(int))!=0) fatal ("runs without a workspace disagree");
+
+		//views: the caller's arrays, no library graph (reversed by swapping directions)
+		const int *of = in.first, *oa = in.adj, *inf = in.ifirst, *ina = in.iadj;
+		domlib_neighbors onb = outNeighbors, inb = inNeighbors;
+		if (flags & DOMLIB_REVERSE) {
+			of = in.ifirst; oa = in.iadj; inf = in.first; ina = in.adj;
+			onb = inNeighbors; inb = outNeighbors;
+		}
+		if (views && domlib_compute_csr (in.n, source, of, oa, inf, ina, method, shared, idom)==DOMLIB_EMETHOD) views = 0;
+		if (views) {
+			t = now();
+			for (int r=0; r<repeat; r++) check (domlib_compute_csr (in.n, source, of, oa, inf, ina, method, shared, idom), name);
+			tcsrview += (now() - t) / repeat;
+			if (memcmp (idom, ref, (in.n+1) * sizeof(int))!=0) fatal ("csr view runs disagree");
+
+			t = now();
+			for (int r=0; r<repeat; r++) check (domlib_compute_view (in.n, source, onb, inb, &in, method, shared, idom), name);
+			tcbview += (now() - t) / repeat;
+			if (memcmp (idom, ref, (in.n+1) * sizeof(int))!=0) fatal ("callback view runs disagree");
+		}
+
+		vertices += in.n;
+		arcs += domlib_graph_arcs (g);
+		count++;
+		domlib_graph_destroy (g);
+		freeInput (&in);
+	}
+	if (list) fclose (list);
+
+	fprintf (stdout, "libversion %d\n", domlib_version());
+	fprintf (stdout, "method %s\n", domlib_method_name (method));
+	fprintf (stdout, "graphs %d\n", count);
+	fprintf (stdout, "ignored %d\n", ignored);
+	fprintf (stdout, "vertices %lld\n", vertices);
+	fprintf (stdout, "arcs %lld\n", arcs);
+	fprintf (stdout, "repeat %d\n", repeat);
+	fprintf (stdout, "createarcstime %.9f\n", tarcs);
+	fprintf (stdout, "createcsrtime %.9f\n", tcsr);
+	fprintf (stdout, "coldtime %.9f\n", tcold);
+	fprintf (stdout, "warmtime %.9f\n", twarm);
+	fprintf (stdout, "noworkspacetime %.9f\n", tnows);
+	if (twarm>0.0) fprintf (stdout, "workspacespeedup %.4f\n", tnows / twarm);
+	fprintf (stdout, "workspacebytes %lu\n", (unsigned long)domlib_workspace_bytes (shared));
+	fprintf (stdout, "views %d\n", views);
+	if (views) {
+		fprintf (stdout, "csrviewtime %.9f\n", tcsrview);
+		fprintf (stdout, "callbackviewtime %.9f\n", tcbview);
+	}
+
+	domlib_workspace_destroy (shared);
+	free (idom);
+	free (ref);
+	return 0;
+}
@@ -0,0 +1,283 @@
+/* Generates synthetic inputs for the dominators code, in DIMACS
+   format ("p n m source sink" followed by "a v w" lines):
+   - chain:  a long path closed by an arc from its end to its second
+             vertex (deep dfs and deep compress recursion)
+   - ladder: a path whose consecutive vertices are joined in both 
+             directions, entered at both ends: whatever the dfs, a 
+             correct dominator moves one step per pass (about n 
+             iterations for idfs)
+   - random: random arcs on top of a random spanning tree (dense if
+             the average degree is high)
+   - cfg:    reducible control-flow graphs built from nested 
+             sequences, branches and loops (with breaks)
+   - dag:    random acyclic graphs (topological order is the label)
+   All generators are deterministic given the seed. */
+
+#include "dom_random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*------------------------------------------
+ | growable list of arcs (pairs of labels)
+ *-----------------------------------------*/
+
+class ArcList {
+	private:
+		int *arcs;
+		int count, capacity;
+	public:
+		ArcList() {capacity = 1024; count = 0; arcs = new int [2*capacity];}
+		~ArcList() {delete [] arcs;}
+		void add (int v, int w) {
+			if (count==capacity) {
+				int *bigger = new int [4*capacity];
+				memcpy (bigger, arcs, 2*count*sizeof(int));
+				delete [] arcs;
+				arcs = bigger;
+				capacity *= 2;
+			}
+			arcs[2*count] = v;
+			arcs[2*count+1] = w;
+			count++;
+		}
+		int getCount() const {return count;}
+		void shuffle (Random &random) { //so that input order carries no information
+			for (int i=count-1; i>0; i--) {
+				int j = random.get(i+1);
+				int v = arcs[2*i], w = arcs[2*i+1];
+				arcs[2*i] = arcs[2*j]; arcs[2*i+1] = arcs[2*j+1];
+				arcs[2*j] = v; arcs[2*j+1] = w;
+			}
+		}
+		void write (FILE *file, int n, int source, int sink) const {
+			fprintf (file, "p %d %d %d %d\n", n, count, source, sink);
+			for (int i=0; i<count; i++) fprintf (file, "a %d %d\n", arcs[2*i], arcs[2*i+1]);
+		}
+};
+
+
+/*------------
+ | generators 
+ *-----------*/
+
+//path 1->2->...->n plus (n,2); returns the sink
+int genChain (int n, Random &, ArcList &arcs) {
+	for (int v=1; v<n; v++) arcs.add (v, v+1);
+	if (n>2) arcs.add (n, 2);
+	return n;
+}
+
+/*----------------------------------------------------------------
+ | ladder: root 1 enters the path 2..n at both ends, and consecutive
+ | vertices of the path are joined in both directions. Whichever end
+ | the dfs takes first, reverse post-order follows the path, the arcs
+ | against it are back arcs, and the idom of every path vertex (the
+ | root) only propagates one vertex per pass from the far end
+ *---------------------------------------------------------------*/
+int genLadder (int n, Random &, ArcList &arcs) {
+	arcs.add (1, 2);
+	arcs.add (1, n);
+	for (int v=2; v<n; v++) {
+		arcs.add (v, v+1);
+		arcs.add (v+1, v);
+	}
+	return n;
+}
+
+//random spanning tree rooted at 1 plus (d-1)*n random arcs
+int genRandom (int n, int d, Random &random, ArcList &arcs) {
+	for (int v=2; v<=n; v++) arcs.add (random.get(1,v-1), v);
+	long long extra = (long long)(d-1) * n;
+	for (long long i=0; i<extra; i++) arcs.add (random.get(1,n), random.get(1,n));
+	return n;
+}
+
+//random dag: every vertex v>1 gets 1..d arcs from lower labels, mostly nearby
+int genDag (int n, int d, Random &random, ArcList &arcs) {
+	for (int v=2; v<=n; v++) {
+		int k = random.get(1,d);
+		for (int j=0; j<k; j++) {
+			int lo = (random.get(4)==0) ? 1 : ((v>64) ? v-64 : 1);
+			arcs.add (random.get(lo,v-1), v);
+		}
+	}
+	return n;
+}
+
+
+/*------------------------------------------------------------------
+ | structured control flow: cfgBlock emits a single-entry,
+ | single-exit region between 'entry' and 'exit' using about 
+ | 'budget' new vertices; loops add a back arc to their header and 
+ | occasional breaks to the loop exit, so the graph is reducible
+ *-----------------------------------------------------------------*/
+
+struct CFGState {
+	Random *random;
+	ArcList *arcs;
+	int next; //next free label
+};
+
+void cfgBlock (CFGState &s, int entry, int exit, int budget, int loopexit) {
+	if (budget<=1) {
+		s.arcs->add (entry, exit);
+		return;
+	}
+	int kind = s.random->get(10);
+	if (kind<4) { //sequence: entry -> m -> exit
+		int m = s.next++;
+		int left = s.random->get(1, budget-1);
+		cfgBlock (s, entry, m, left, loopexit);
+		cfgBlock (s, m, exit, budget-1-left, loopexit);
+	} else if (kind<7) { //if-then-else
+		int t = s.next++, e = s.next++;
+		s.arcs->add (entry, t);
+		s.arcs->add (entry, e);
+		int left = (budget-2>1) ? s.random->get(1, budget-2) : 1;
+		cfgBlock (s, t, exit, left, loopexit);
+		cfgBlock (s, e, exit, budget-2-left, loopexit);
+	} else { //while loop: entry -> header -> body -> header; header -> exit
+		int header = s.next++, body = s.next++;
+		s.arcs->add (entry, header);
+		s.arcs->add (header, body);
+		s.arcs->add (header, exit);
+		int latch = s.next++;
+		cfgBlock (s, body, latch, budget-3, exit);
+		s.arcs->add (latch, header); //back arc
+		if (s.random->get(4)==0) s.arcs->add (body, exit); //break
+		if (loopexit && s.random->get(8)==0) s.arcs->add (body, loopexit); //break out of the outer loop
+	}
+}
+
+int genCFG (int n, Random &random, ArcList &arcs, int &nvertices) {
+	CFGState s;
+	s.random = &random;
+	s.arcs = &arcs;
+	s.next = 3; //1 is the entry, 2 the exit
+	cfgBlock (s, 1, 2, n-2, 0);
+	nvertices = s.next-1;
+	return 2;
+}
+
+
+/*-----------------------------------------------------------
+ | generate one graph of the given family into 'filename'
+ *----------------------------------------------------------*/
+
+bool generate (const char *family, int n, unsigned long long seed, const char *filename) {
+	Random random (seed);
+	ArcList arcs;
+	int sink, nvertices = n;
+
+	if (strcmp(family, "chain")==0) sink = genChain (n, random, arcs);
+	else if (strcmp(family, "ladder")==0) sink = genLadder (n, random, arcs);
+	else if (strcmp(family, "random")==0) sink = genRandom (n, 4, random, arcs);
+	else if (strcmp(family, "dense")==0) sink = genRandom (n, 32, random, arcs);
+	else if (strcmp(family, "dag")==0) sink = genDag (n, 4, random, arcs);
+	else if (strcmp(family, "cfg")==0) sink = genCFG (n, random, arcs, nvertices);
+	else return false;
+
+	arcs.shuffle (random);
+
+	FILE *file = filename ? fopen (filename, "w") : stdout;
+	if (!file) {
+		fprintf (stderr, "Error opening file \"%s\".\n", filename);
+		exit(-1);
+	}
+	arcs.write (file, nvertices, 1, sink);
+	if (filename) fclose (file);
+	return true;
+}
+
+
+/*-----------------------------------------------------------------
+ | benchmark corpus: every family at a few sizes (one series per 
+ | family), plus a series of many small cfgs; all.series has all
+ | the large graphs
+ *----------------------------------------------------------------*/
+
+const char *families[] = {"chain", "ladder", "random", "dense", "cfg", "dag"};
+const int NFAMILIES = 6;
+
+void generateCorpus (const char *dir, int scale) {
+	char filename[1024], seriesname[1024];
+	int sizes[3] = {scale/100, scale/10, scale};
+
+	sprintf (seriesname, "%s/all.series", dir);
+	FILE *all = fopen (seriesname, "w");
+	if (!all) {
+		fprintf (stderr, "Error opening file \"%s\" (does the directory exist?).\n", seriesname);
+		exit(-1);
+	}
+
+	for (int f=0; f<NFAMILIES; f++) {
+		sprintf (seriesname, "%s/%s.series", dir, families[f]);
+		FILE *series = fopen (seriesname, "w");
+		if (!series) {
+			fprintf (stderr, "Error opening file \"%s\".\n", seriesname);
+			exit(-1);
+		}
+		for (int s=0; s<3; s++) {
+			int n = sizes[s];
+			if (strcmp(families[f], "ladder")==0) n /= 10; //quadratic for the iterative methods
+			if (strcmp(families[f], "dense")==0) n /= 10;  //32 arcs per vertex
+			if (n<8) n = 8;
+			sprintf (filename, "%s/%s-%d.dimacs", dir, families[f], n);
+			generate (families[f], n, 1000*f+s+1, filename);
+			fprintf (series, "%s\n", filename);
+			fprintf (all, "%s\n", filename);
+			fprintf (stderr, "%s\n", filename);
+		}
+		fclose (series);
+	}
+	fclose (all);
+
+	//many small control-flow graphs
+	sprintf (seriesname, "%s/cfgsmall.series", dir);
+	FILE *series = fopen (seriesname, "w");
+	if (!series) {
+		fprintf (stderr, "Error opening file \"%s\".\n", seriesname);
+		exit(-1);
+	}
+	Random random (4242);
+	for (int i=0; i<200; i++) {
+		int n = random.get(16, 2000);
+		sprintf (filename, "%s/cfgsmall-%03d.dimacs", dir, i);
+		generate ("cfg", n, 5000+i, filename);
+		fprintf (series, "%s\n", filename);
+	}
+	fclose (series);
+	fprintf (stderr, "%s\n", seriesname);
+}
+
+
+void printUsage (const char *command) {
+	fprintf (stderr, "Usage: %s <family> <n> [seed] [output file]\n", command);
+	fprintf (stderr, "       %s -corpus <directory> [scale]\n", command);
+	fprintf (stderr, "Families:");
+	for (int f=0; f<NFAMILIES; f++) fprintf (stderr, " %s", families[f]);
+	fprintf (stderr, "\n\n");
+	exit(-1);
+}
+
+int main (int argc, char *argv[]) {
+	if (argc<3) printUsage (argv[0]);
+
+	if (strcmp(argv[1], "-corpus")==0) {
+		int scale = (argc>3) ? atoi(argv[3]) : 100000;
+		generateCorpus (argv[2], scale);
+		return 0;
+	}
+
+	int n = atoi(argv[2]);
+	unsigned long long seed = (argc>3) ? strtoull(argv[3], NULL, 10) : 1;
+	const char *filename = (argc>4) ? argv[4] : NULL;
+	if (n<3) {
+		fprintf (stderr, "ERROR: need at least 3 vertices.\n");
+		exit(-1);
+	}
+	if (!generate (argv[1], n, seed, filename)) printUsage (argv[0]);
+	return 0;
+}
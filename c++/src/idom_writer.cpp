@@ -0,0 +1,147 @@
+/*************************************
+ *
+ * OutputBuffer, IdomWriter 
+ * (see idom_writer.h)
+ *
+ *************************************/
+
+#include "idom_writer.h"
+#include "rfw_timer.h"
+#include "dom_tree.h"
+#include <stdlib.h>
+#include <string.h>
+
+OutputBuffer::OutputBuffer (FILE *_file, size_t _size) {
+	file = _file;
+	size = (_size < 64) ? 64 : _size;
+	buffer = (char *)malloc (size);
+	used = 0;
+	written = 0;
+	failed = false;
+}
+
+OutputBuffer::~OutputBuffer() {
+	flush();
+	free (buffer);
+}
+
+void OutputBuffer::flush() {
+	if (used==0) return;
+	if (fwrite (buffer, 1, used, file) != used) failed = true;
+	written += (long long)used;
+	used = 0;
+}
+
+void OutputBuffer::putBytes (const void *data, size_t bytes) {
+	const char *s = (const char *)data;
+	while (bytes) {
+		if (used==size) flush();
+		size_t k = size - used;
+		if (k > bytes) k = bytes;
+		memcpy (buffer + used, s, k);
+		used += k;
+		s += k;
+		bytes -= k;
+	}
+}
+
+void OutputBuffer::putInt32 (int x) {
+	if (size-used < 4) flush();
+	unsigned int u = (unsigned int)x;
+	for (int i=0; i<4; i++) {buffer[used++] = (char)(u & 0xff); u >>= 8;}
+}
+
+void OutputBuffer::putInt64 (long long x) {
+	if (size-used < 8) flush();
+	unsigned long long u = (unsigned long long)x;
+	for (int i=0; i<8; i++) {buffer[used++] = (char)(u & 0xff); u >>= 8;}
+}
+
+
+/*-----------------
+ | format names 
+ *----------------*/
+
+static const char *fnames[IdomWriter::FORMATS] = {"text", "bin32", "bin64", "csr"};
+
+const char *IdomWriter::getName (Format f) {return fnames[f];}
+
+bool IdomWriter::parseFormat (const char *name, Format &f) {
+	for (int i=0; i<FORMATS; i++) {
+		if (strcmp (name, fnames[i])==0) {f = (Format)i; return true;}
+	}
+	return false;
+}
+
+
+/*-------------------------------------------------------------
+ | the header is written field by field so that it is 
+ | little-endian (and unpadded: 40 bytes) on every platform
+ *------------------------------------------------------------*/
+
+static void putHeader (OutputBuffer &out, const char *magic, int width, long long n, long long root, long long count) {
+	char m[8];
+	memset (m, 0, 8);
+	memcpy (m, magic, strlen (magic));
+	out.putBytes (m, 8);
+	out.putInt32 (1);
+	out.putInt32 (width);
+	out.putInt64 (n);
+	out.putInt64 (root);
+	out.putInt64 (count);
+}
+
+bool IdomWriter::write (FILE *file, int n, const int *idom, int root) {
+	RFWTimer timer(true);
+	OutputBuffer out (file);
+	int v;
+
+	switch (format) {
+		case TEXT:
+			for (v=1; v<=n; v++) {
+				out.putInt (v);
+				out.putChar (' ');
+				out.putInt (idom[v]);
+				out.putChar ('\n');
+			}
+			break;
+
+		case BIN32:
+			putHeader (out, "DOMIDOM", 4, n, root, n+1);
+			out.putInt32 (0);
+			for (v=1; v<=n; v++) out.putInt32 (idom[v]);
+			break;
+
+		case BIN64:
+			putHeader (out, "DOMIDOM", 8, n, root, n+1);
+			out.putInt64 (0);
+			for (v=1; v<=n; v++) out.putInt64 (idom[v]);
+			break;
+
+		case CSR: {
+			DominatorTree tree;
+			tree.build (n, idom, root);
+			const DominatorTree::View &t = tree.getView();
+			int count = t.first[n+1];
+			putHeader (out, "DOMTREE", 4, n, root, count);
+			for (v=0; v<=n+1; v++) out.putInt32 (t.first[v]);
+			for (v=0; v<count; v++) out.putInt32 (t.children[v]);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	out.flush();
+	bytes += out.getBytes(); //totals over all calls (e.g., a pipelined series)
+	time += timer.getTime();
+	return out.ok();
+}
+
+
+void IdomWriter::output (FILE *file) const {
+	fprintf (file, "idomformat %s\n", fnames[format]);
+	fprintf (file, "idombytes %lld\n", bytes);
+	fprintf (file, "idomwritetime %.6f\n", time);
+}
@@ -0,0 +1,101 @@
+/**********************************************************
+ *
+ * OutputBuffer
+ * - buffered writer with hand-rolled integer formatting 
+ *   (no fprintf per value); flushed when full and on close
+ *
+ * IdomWriter
+ * - writes the immediate dominators of a graph in one of
+ *   several formats:
+ *   - text: one "v idom[v]" line per vertex (the original
+ *     format)
+ *   - bin32/bin64: an IdomHeader followed by idom[0..n] as
+ *     little-endian int32 or int64
+ *   - csr: an IdomHeader (width 4) followed by the children
+ *     of every vertex in the dominator tree, as a CSR: n+2
+ *     little-endian int32 offsets, then the children (the
+ *     children of v are in positions first[v]..first[v+1]-1)
+ * - unreachable vertices have idom 0; the root is its own 
+ *   idom (and is nobody's child)
+ *
+ **********************************************************/
+
+#ifndef idom_writer_h
+#define idom_writer_h
+
+#include <stdio.h>
+
+class OutputBuffer {
+	private:
+		FILE *file;
+		char *buffer;
+		size_t size, used;
+		long long written; //bytes handed to the file so far
+		bool failed;
+
+	public:
+		static const size_t DEFAULT_SIZE = 1<<20;
+
+		OutputBuffer (FILE *_file, size_t _size = DEFAULT_SIZE);
+		~OutputBuffer(); //flushes
+
+		void flush();
+		bool ok() const {return !failed;}
+		long long getBytes() const {return written + (long long)used;}
+
+		inline void putChar (char c) {
+			if (used==size) flush();
+			buffer[used++] = c;
+		}
+
+		inline void putInt (long long x) {
+			if (size-used < 24) flush();
+			char *p = buffer + used;
+			unsigned long long u = (unsigned long long)x;
+			if (x<0) {*(p++) = '-'; u = 0ULL - u;}
+			char digits[20];
+			int k = 0;
+			do {digits[k++] = (char)('0' + u%10); u /= 10;} while (u);
+			while (k) *(p++) = digits[--k];
+			used = p - buffer;
+		}
+
+		void putBytes (const void *data, size_t bytes);
+		void putInt32 (int x);        //little-endian
+		void putInt64 (long long x);  //little-endian
+};
+
+
+class IdomWriter {
+	public:
+		typedef enum {TEXT, BIN32, BIN64, CSR, FORMATS} Format;
+
+		//header of the binary formats (itself little-endian)
+		typedef struct {
+			char magic[8];   //"DOMIDOM" (bin32/bin64) or "DOMTREE" (csr)
+			int version;     //1
+			int width;       //bytes per entry (4 or 8)
+			long long n;     //number of vertices
+			long long root;
+			long long count; //entries after the header (excluding offsets)
+		} IdomHeader;
+
+	private:
+		Format format;
+		double time;      //seconds spent writing (wall clock)
+		long long bytes;
+
+	public:
+		IdomWriter (Format _format = TEXT) : format(_format), time(0.0), bytes(0) {}
+		void setFormat (Format _format) {format = _format;}
+		Format getFormat () const {return format;}
+		static bool parseFormat (const char *name, Format &f); //text, bin32, bin64, or csr
+		static const char *getName (Format f);
+
+		//idom[1..n]; returns false on write errors
+		bool write (FILE *file, int n, const int *idom, int root);
+
+		void output (FILE *file) const; //"name value" lines
+};
+
+#endif
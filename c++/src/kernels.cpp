@@ -0,0 +1,375 @@
+/* Microbenchmarks for the hot kernels of the dominators code:
+   - compress:     rcompress(v,parent,label,c), as in snca (and snca-pf)
+   - compresssemi: rcompress(v,parent,semi,label,c), as in slt (and slt-pf)
+   - linkeval:     lt_neg_eval and lt_neg_link, the forest lt had
+                   before the link-eval policies
+   - linkevalsized: eval and link of SizedForest<PathCompress>, as
+                   used by lt (linkevalhalve/linkevalsplit: with
+                   PathHalve and PathSplit)
+   - intersect:    viewIntersect (post-ids, as in idfs)
+   - preintersect: viewPreIntersect (pre-ids, as in ibfs)
+   - dfs:          preDFSp (recursive rpreDFSp)
+   Each kernel runs over synthetic forests whose shape is controlled 
+   by a window w (the parent of i is one of the w vertices before it: 
+   w=1 gives a path, large w a shallow random tree), or over the 
+   dfs/dominator trees of a given graph; reports ns/op and ops/s. */
+
+#include "dgraph.h"
+#include "dgraph_linkeval.h"
+#include "dgraph_view.h"
+#include "rfw_timer.h"
+#include "dom_random.h"
+#include "dom_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------
+ | the benchmarks themselves; KernelBench is a friend of 
+ | DominatorGraph so that it can call the kernels directly
+ *-------------------------------------------------------------*/
+
+class KernelBench {
+	private:
+		DominatorGraph g; //only used to call the kernels
+		double mintime;   //minimum time per measurement
+		unsigned long long seed;
+
+		void report (const char *kernel, const char *shape, int n, double ops, double seconds) {
+			fprintf (stdout, "%-13s %-10s %9d %12.0f %10.4f %10.2f %10.2f\n", kernel, shape, n, ops, 
+			         seconds, 1e9 * seconds / ops, ops / seconds / 1e6);
+			fflush (stdout);
+		}
+
+		//parent[i] in [i-w,i-1] for i>1 (pre-ids), parent[1]=0
+		void makeForest (int n, int w, Random &random, int *parent) {
+			parent[1] = 0;
+			for (int i=2; i<=n; i++) parent[i] = random.get ((i-w>1) ? i-w : 1, i-1);
+		}
+
+	public:
+		KernelBench (double t, unsigned long long s) {mintime = t; seed = s;}
+
+		static void header() {
+			fprintf (stdout, "%-13s %-10s %9s %12s %10s %10s %10s\n", "kernel", "shape", "n", "ops", "seconds", "ns/op", "Mops/s");
+		}
+
+		/*--------------------------------------------------------------
+		 | compress, as in snca/slt: vertices are processed in reverse 
+		 | pre-order and, for each i, 'q' random vertices v>i are 
+		 | compressed up to i; forests are restored between sweeps 
+		 | (untimed)
+		 *-------------------------------------------------------------*/
+		void compress (const char *shape, int n, int w, bool withsemi) {
+			const int q = 2;
+			Random random (seed);
+			int *base = new int [n+1];
+			int *parent = new int [n+1];
+			int *label = new int [n+1];
+			int *semi = new int [n+1];
+			int *queries = new int [q*(n+1)];
+			makeForest (n, w, random, base);
+			for (int i=2; i<n; i++) {
+				for (int j=0; j<q; j++) queries[q*i+j] = random.get (i+1, n);
+			}
+
+			double ops = 0;
+			RFWTimer timer;
+			do {
+				//restore the forest (untimed)
+				memcpy (parent, base, (n+1)*sizeof(int));
+				for (int i=0; i<=n; i++) {label[i] = i; semi[i] = base[i];}
+
+				timer.resume();
+				if (withsemi) {
+					for (int i=n-1; i>1; i--) {
+						for (int j=0; j<q; j++) g.rcompress (queries[q*i+j], parent, semi, label, i);
+					}
+				} else {
+					for (int i=n-1; i>1; i--) {
+						for (int j=0; j<q; j++) g.rcompress (queries[q*i+j], parent, label, i);
+					}
+				}
+				timer.pause();
+				ops += (double)q * (n-2);
+			} while (timer.getTime() < mintime);
+
+			report (withsemi ? "compresssemi" : "compress", shape, n, ops, timer.getTime());
+			delete [] queries;
+			delete [] semi;
+			delete [] label;
+			delete [] parent;
+			delete [] base;
+		}
+
+		/*-------------------------------------------------------------
+		 | link-eval as in lt: vertices are processed in reverse 
+		 | pre-order; for each i, 'q' random vertices v>i (already 
+		 | linked) are evaluated, then i is linked to its parent. 
+		 | One op is either an eval or a link. Path: the policy of a
+		 | SizedForest; without one, lt_neg_eval and lt_neg_link.
+		 *------------------------------------------------------------*/
+		void makeLinkEval (int n, int w, int q, Random &random, int *parent, int *basesemi, int *queries) {
+			makeForest (n, w, random, parent);
+			basesemi[0] = 0;
+			basesemi[1] = 1;
+			for (int i=2; i<=n; i++) basesemi[i] = random.get (1, parent[i]); //semi[i]<=parent[i]
+			for (int i=2; i<n; i++) {
+				for (int j=0; j<q; j++) queries[q*i+j] = random.get (i+1, n);
+			}
+		}
+
+		void linkeval (const char *shape, int n, int w) {
+			const int q = 2;
+			Random random (seed);
+			int *parent = new int [n+1];
+			int *basesemi = new int [n+1];
+			int *semi = new int [n+1];
+			int *label = new int [n+1];
+			int *ancestor = new int [n+1];
+			int *size = new int [n+1];
+			int *queries = new int [q*(n+1)];
+			makeLinkEval (n, w, q, random, parent, basesemi, queries);
+
+			double ops = 0;
+			RFWTimer timer;
+			do {
+				for (int i=0; i<=n; i++) { //untimed
+					label[i] = i;
+					semi[i] = basesemi[i];
+					ancestor[i] = 0;
+					size[i] = 1;
+				}
+				size[0] = 0;
+
+				timer.resume();
+				g.lt_neg_link (parent[n], n, semi, label, ancestor, size);
+				for (int i=n-1; i>1; i--) {
+					for (int j=0; j<q; j++) g.lt_neg_eval (queries[q*i+j], ancestor, semi, label);
+					g.lt_neg_link (parent[i], i, semi, label, ancestor, size);
+				}
+				timer.pause();
+				ops += (double)(q+1) * (n-2) + 1;
+			} while (timer.getTime() < mintime);
+
+			report ("linkeval", shape, n, ops, timer.getTime());
+			delete [] queries;
+			delete [] size;
+			delete [] ancestor;
+			delete [] label;
+			delete [] semi;
+			delete [] basesemi;
+			delete [] parent;
+		}
+
+		template <class Path> void linkeval (const char *kernel, const char *shape, int n, int w) {
+			const int q = 2;
+			Random random (seed);
+			int *parent = new int [n+1];
+			int *basesemi = new int [n+1];
+			int *semi = new int [n+1];
+			int *label = new int [n+1];
+			int *arrays = new int [SizedForest<Path>::words(n)];
+			int *queries = new int [q*(n+1)];
+			makeLinkEval (n, w, q, random, parent, basesemi, queries);
+
+			double ops = 0;
+			RFWTimer timer;
+			do {
+				for (int i=0; i<=n; i++) { //untimed
+					label[i] = i;
+					semi[i] = basesemi[i];
+				}
+				SizedForest<Path> forest (g.ccount, parent, semi, label, arrays, n);
+
+				timer.resume();
+				forest.link (parent[n], n);
+				for (int i=n-1; i>1; i--) {
+					for (int j=0; j<q; j++) forest.eval (queries[q*i+j], i);
+					forest.link (parent[i], i);
+				}
+				timer.pause();
+				ops += (double)(q+1) * (n-2) + 1;
+			} while (timer.getTime() < mintime);
+
+			report (kernel, shape, n, ops, timer.getTime());
+			delete [] queries;
+			delete [] arrays;
+			delete [] label;
+			delete [] semi;
+			delete [] basesemi;
+			delete [] parent;
+		}
+
+		/*-------------------------------------------------------------
+		 | nca queries on random pairs; 'dom' is a tree with dom[v]<v 
+		 | (pre-ids, root 1) for preIntersect; intersect gets the same 
+		 | tree with ids mirrored (dom[v]>v, root n)
+		 *------------------------------------------------------------*/
+		void intersect (const char *shape, int n, int *predom, bool pre) {
+			const int nq = 1<<12;
+			Random random (seed);
+			int *dom = new int [n+1];
+			int *queries = new int [2*nq];
+			for (int i=1; i<=n; i++) dom[i] = pre ? predom[i] : n+1-predom[n+1-i];
+			for (int i=0; i<2*nq; i++) queries[i] = random.get (1, n);
+
+			double ops = 0;
+			int sum = 0; //keeps the compiler honest
+			RFWTimer timer(true);
+			do {
+				if (pre) {
+					for (int i=0; i<nq; i++) sum += viewPreIntersect (queries[2*i], queries[2*i+1], dom, g.ccount);
+				} else {
+					for (int i=0; i<nq; i++) sum += viewIntersect (queries[2*i], queries[2*i+1], dom, g.ccount);
+				}
+				ops += nq;
+			} while (timer.getTime() < mintime);
+
+			report (pre ? "preintersect" : "intersect", shape, n, ops, timer.getTime());
+			if (sum==42) fprintf (stderr, " ");
+			delete [] queries;
+			delete [] dom;
+		}
+
+		void intersect (const char *shape, int n, int w, bool pre) {
+			Random random (seed);
+			int *predom = new int [n+1];
+			makeForest (n, w, random, predom);
+			predom[1] = 1;
+			intersect (shape, n, predom, pre);
+			delete [] predom;
+		}
+
+		/*------------------------------------------------------
+		 | preDFSp on a graph; one op is a vertex or an arc
+		 *-----------------------------------------------------*/
+		void dfs (const char *shape, DominatorGraph &graph) {
+			int n = graph.getNVertices();
+			int *buffer = new int [3*(n+1)];
+			int visited = 0;
+			double ops = 0;
+			RFWTimer timer(true);
+			do {
+				visited = graph.preDFSp (graph.getSource(), &buffer[0], &buffer[n+1], &buffer[2*(n+1)]);
+				ops += n + graph.getNArcs();
+			} while (timer.getTime() < mintime);
+			report ("dfs", shape, visited, ops, timer.getTime());
+			delete [] buffer;
+		}
+
+		void dfs (const char *shape, int n, int w) {
+			Random random (seed);
+			int *parent = new int [n+1];
+			makeForest (n, w, random, parent);
+			int m = (n-1) + 3*n; //tree plus 3 random arcs per vertex
+			int *arclist = new int [2*m];
+			int p = 0;
+			for (int i=2; i<=n; i++) {arclist[p++] = parent[i]; arclist[p++] = i;}
+			while (p<2*m) {arclist[p++] = random.get (1, n); arclist[p++] = random.get (1, n);}
+			DominatorGraph graph;
+			graph.buildGraph (n, m, 1, arclist, false);
+			delete [] arclist;
+			delete [] parent;
+			dfs (shape, graph);
+		}
+
+		/*------------------------------------------------------------
+		 | recorded patterns: the dfs of a given graph, and nca queries
+		 | on its dominator tree (in dfs pre-order)
+		 *-----------------------------------------------------------*/
+		void recorded (const char *filename) {
+			DominatorGraph graph;
+			const char *error = graph.readDimacs (filename, false, false);
+			if (error) {
+				fprintf (stderr, "ERROR: %s (%s).\n", error, filename);
+				exit(-1);
+			}
+			dfs ("graph", graph);
+
+			int n = graph.getNVertices();
+			int *idom = new int [n+1];
+			int *label2pre = new int [n+1];
+			int *pre2label = new int [n+1];
+			int *parent = new int [n+1];
+			graph.lt (graph.getSource(), idom);
+			int N = graph.preDFSp (graph.getSource(), label2pre, pre2label, parent);
+			int *predom = new int [N+1];
+			for (int i=1; i<=N; i++) predom[i] = label2pre[idom[pre2label[i]]];
+			predom[1] = 1;
+			intersect ("graph", N, predom, true);
+			intersect ("graph", N, predom, false);
+			delete [] predom;
+			delete [] parent;
+			delete [] pre2label;
+			delete [] label2pre;
+			delete [] idom;
+		}
+};
+
+
+void printUsage (const char *command) {
+	fprintf (stderr, "Usage: %s [-size <n>] [-mintime <seconds>] [-seed <s>] [-graph <dimacs file>]\n", command);
+	fprintf (stderr, "Kernels: compress compresssemi linkeval linkevalsized linkevalhalve linkevalsplit intersect preintersect dfs\n\n");
+	exit(-1);
+}
+
+//options of a run; the kernels run on a DomThread (paths of n vertices recurse n deep)
+struct KernelRun {
+	int size; //0: default sizes
+	double mintime;
+	unsigned long long seed;
+	const char *graphfile;
+};
+
+static void runKernels (void *argument) {
+	KernelRun &run = *(KernelRun *)argument;
+
+	/*---
+	 | shapes: path (depth n), window 16 (depth about n/8), and 
+	 | random recursive tree (depth about ln n); sizes that fit in 
+	 | cache and sizes that do not
+	 *--*/
+	int sizes[2] = {1000, 100000};
+	int nsizes = 2;
+	if (run.size) {sizes[0] = run.size; nsizes = 1;}
+	const char *shapes[3] = {"path", "window16", "random"};
+
+	KernelBench bench (run.mintime, run.seed);
+	KernelBench::header();
+	for (int s=0; s<nsizes; s++) {
+		int n = sizes[s];
+		int windows[3] = {1, 16, n};
+		for (int k=0; k<3; k++) bench.compress (shapes[k], n, windows[k], false);
+		for (int k=0; k<3; k++) bench.compress (shapes[k], n, windows[k], true);
+		for (int k=0; k<3; k++) bench.linkeval (shapes[k], n, windows[k]);
+		for (int k=0; k<3; k++) bench.linkeval<PathCompress> ("linkevalsized", shapes[k], n, windows[k]);
+		for (int k=0; k<3; k++) bench.linkeval<PathHalve> ("linkevalhalve", shapes[k], n, windows[k]);
+		for (int k=0; k<3; k++) bench.linkeval<PathSplit> ("linkevalsplit", shapes[k], n, windows[k]);
+		for (int k=0; k<3; k++) bench.intersect (shapes[k], n, windows[k], false);
+		for (int k=0; k<3; k++) bench.intersect (shapes[k], n, windows[k], true);
+		for (int k=0; k<3; k++) bench.dfs (shapes[k], n, windows[k]);
+	}
+	if (run.graphfile) bench.recorded (run.graphfile);
+}
+
+int main (int argc, char *argv[]) {
+	KernelRun run;
+	run.size = 0;
+	run.mintime = 0.25;
+	run.seed = 1;
+	run.graphfile = NULL;
+
+	for (int i=1; i<argc; i++) {
+		if (i+1<argc && strcmp(argv[i], "-size")==0) {run.size = atoi(argv[++i]); continue;}
+		if (i+1<argc && strcmp(argv[i], "-mintime")==0) {run.mintime = atof(argv[++i]); continue;}
+		if (i+1<argc && strcmp(argv[i], "-seed")==0) {run.seed = strtoull(argv[++i], NULL, 10); continue;}
+		if (i+1<argc && strcmp(argv[i], "-graph")==0) {run.graphfile = argv[++i]; continue;}
+		printUsage (argv[0]);
+	}
+
+	DomThread thread;
+	thread.start (runKernels, &run);
+	thread.join();
+	return 0;
+}
@@ -0,0 +1,270 @@
+/*************************************
+ *
+ * libdominators (C interface)
+ *
+ *************************************/
+
+#include "libdominators.h"
+#include "dgraph.h"
+#include "dgraph_view.h"
+#include "mem_policy.h"
+#include "dom_thread.h"
+#include <new>
+
+struct domlib_graph {
+	DominatorGraph g;
+};
+
+struct domlib_workspace {
+	MemArena arena;
+};
+
+//inside the library, allocation failures throw (and become DOMLIB_ENOMEM)
+static struct ThrowOnFailure {
+	ThrowOnFailure() {MemPolicy::setThrow (true);}
+} throwonfailure;
+
+int domlib_version (void) {return DOMLIB_VERSION;}
+
+const char *domlib_strerror (int status) {
+	switch (status) {
+		case DOMLIB_OK: return "success";
+		case DOMLIB_EINVAL: return "invalid argument";
+		case DOMLIB_ENOMEM: return "out of memory";
+		case DOMLIB_EFILE: return "cannot read the graph file";
+		case DOMLIB_EMETHOD: return "unknown method";
+		default: return "unknown error";
+	}
+}
+
+
+/*------------------------------------------------------------
+ | methods: DominatorGraph's list (the codes are its Method)
+ *-----------------------------------------------------------*/
+
+int domlib_method_count (void) {return DominatorGraph::DM_METHODS;}
+const char *domlib_method_name (int method) {return DominatorGraph::getMethodName (method);}
+int domlib_method (const char *name) {return DominatorGraph::getMethod (name);}
+
+
+/*-------------------------------------------------------------
+ | graphs: every input is checked before buildGraph sees it
+ | (it trusts its arcs); reversal swaps the ends of every arc
+ *------------------------------------------------------------*/
+
+static int build (int n, int m, int source, const int *arcs, int flags, domlib_graph **graph) {
+	domlib_graph *h = NULL;
+	int *copy = NULL;
+	try {
+		h = new domlib_graph;
+		const int *list = arcs;
+		if (flags & DOMLIB_REVERSE) {
+			copy = mpNew<int> (2*(size_t)m + 1);
+			for (int i=0; i<m; i++) {
+				copy[2*i] = arcs[2*i+1];
+				copy[2*i+1] = arcs[2*i];
+			}
+			list = copy;
+		}
+		//buildGraph does not write to the list
+		h->g.buildGraph (n, m, source, const_cast<int *>(list), (flags & DOMLIB_SIMPLIFY)!=0);
+		if (copy) mpDelete (copy);
+	} catch (std::bad_alloc &) {
+		if (copy) mpDelete (copy);
+		delete h;
+		return DOMLIB_ENOMEM;
+	}
+	*graph = h;
+	return DOMLIB_OK;
+}
+
+int domlib_graph_from_arcs (int n, int m, int source, const int *arcs, int flags, domlib_graph **graph) {
+	if (!graph) return DOMLIB_EINVAL;
+	*graph = NULL;
+	if (n<1 || m<0 || source<1 || source>n || (m>0 && !arcs)) return DOMLIB_EINVAL;
+	for (size_t i=0; i<2*(size_t)m; i++) {
+		if (arcs[i]<1 || arcs[i]>n) return DOMLIB_EINVAL;
+	}
+	return build (n, m, source, arcs, flags, graph);
+}
+
+int domlib_graph_from_csr (int n, int source, const int *first, const int *adj, int flags, domlib_graph **graph) {
+	if (!graph) return DOMLIB_EINVAL;
+	*graph = NULL;
+	if (n<1 || source<1 || source>n || !first) return DOMLIB_EINVAL;
+	for (int v=1; v<=n; v++) {
+		if (first[v]<0 || first[v+1]<first[v]) return DOMLIB_EINVAL;
+	}
+	int m = first[n+1] - first[1];
+	if (m>0 && !adj) return DOMLIB_EINVAL;
+	for (int i=first[1]; i<first[n+1]; i++) {
+		if (adj[i]<1 || adj[i]>n) return DOMLIB_EINVAL;
+	}
+
+	int *arcs = NULL;
+	try {
+		arcs = mpNew<int> (2*(size_t)m + 1);
+	} catch (std::bad_alloc &) {
+		return DOMLIB_ENOMEM;
+	}
+	int k = 0;
+	for (int v=1; v<=n; v++) {
+		for (int i=first[v]; i<first[v+1]; i++) {
+			arcs[k++] = v;
+			arcs[k++] = adj[i];
+		}
+	}
+	int status = build (n, m, source, arcs, flags, graph);
+	mpDelete (arcs);
+	return status;
+}
+
+int domlib_graph_from_dimacs (const char *filename, int flags, domlib_graph **graph) {
+	if (!graph) return DOMLIB_EINVAL;
+	*graph = NULL;
+	if (!filename) return DOMLIB_EINVAL;
+	domlib_graph *h = NULL;
+	try {
+		h = new domlib_graph;
+		if (h->g.readDimacs (filename, (flags & DOMLIB_REVERSE)!=0, (flags & DOMLIB_SIMPLIFY)!=0)) {
+			delete h;
+			return DOMLIB_EFILE;
+		}
+	} catch (std::bad_alloc &) {
+		delete h;
+		return DOMLIB_ENOMEM;
+	}
+	*graph = h;
+	return DOMLIB_OK;
+}
+
+void domlib_graph_destroy (domlib_graph *graph) {delete graph;}
+
+int domlib_graph_vertices (const domlib_graph *graph) {return graph ? graph->g.getNVertices() : 0;}
+int domlib_graph_arcs (const domlib_graph *graph) {return graph ? graph->g.getNArcs() : 0;}
+int domlib_graph_source (const domlib_graph *graph) {return graph ? graph->g.getSource() : 0;}
+
+
+/*-------------------------------------------------------------
+ | workspaces: the arena is installed for the duration of the
+ | call and reset (grown to this call's needs) afterwards; calls
+ | without one run in an empty arena, which only keeps track of
+ | the blocks, so that those of a failed call are freed too
+ *------------------------------------------------------------*/
+
+int domlib_workspace_create (domlib_workspace **workspace) {
+	if (!workspace) return DOMLIB_EINVAL;
+	*workspace = new (std::nothrow) domlib_workspace;
+	return *workspace ? DOMLIB_OK : DOMLIB_ENOMEM;
+}
+
+void domlib_workspace_destroy (domlib_workspace *workspace) {delete workspace;}
+
+size_t domlib_workspace_bytes (const domlib_workspace *workspace) {
+	return workspace ? workspace->arena.getCapacity() : 0;
+}
+
+//methods on graph views (DominatorGraph runs all of them)
+static bool runView (DominatorGraph &g, int source, int method, int *idom) {
+	g.runMethod (method, source, idom);
+	return true;
+}
+
+template <class View> static bool runView (const View &view, int source, int method, int *idom) {
+	switch (method) {
+		case DominatorGraph::DM_IBFS: viewIbfs (view, source, idom); return true;
+		case DominatorGraph::DM_IDFS: viewIdfs (view, source, idom); return true;
+		case DominatorGraph::DM_LT:   viewLt   (view, source, idom); return true;
+		case DominatorGraph::DM_SLT:  viewSlt  (view, source, idom); return true;
+		case DominatorGraph::DM_SNCA: viewSnca (view, source, idom); return true;
+		default: return false;
+	}
+}
+
+//runs method on view (a DominatorGraph or a graph view) with workspace installed
+template <class View> static int computeHere (View &view, int source, int method, domlib_workspace *workspace, int *idom) {
+	MemArena scratch; //frees what a failed call leaves behind
+	MemArena *previous = MemPolicy::setArena (workspace ? &workspace->arena : &scratch);
+	int status = DOMLIB_OK;
+	try {
+		if (!runView (view, source, method, idom)) status = DOMLIB_EMETHOD;
+	} catch (std::bad_alloc &) {
+		status = DOMLIB_ENOMEM;
+	}
+	MemPolicy::setArena (previous);
+	if (workspace) workspace->arena.reset();
+	return status;
+}
+
+
+/*-------------------------------------------------------------
+ | the methods recurse once per tree level (dfs, compress), so
+ | graphs above INLINEMAX vertices are computed on a DomThread
+ | (large stack) rather than on the caller's stack
+ *------------------------------------------------------------*/
+
+static const int INLINEMAX = 1<<10;
+
+template <class View> struct ComputeCall {
+	View *view;
+	int source, method;
+	domlib_workspace *workspace;
+	int *idom;
+	int status;
+
+	static void run (void *argument) {
+		ComputeCall *call = (ComputeCall *)argument;
+		call->status = computeHere (*call->view, call->source, call->method, call->workspace, call->idom);
+	}
+};
+
+template <class View> static int compute (View &view, int source, int method, domlib_workspace *workspace, int *idom) {
+	if (view.getNVertices() <= INLINEMAX) return computeHere (view, source, method, workspace, idom);
+
+	ComputeCall<View> call = {&view, source, method, workspace, idom, DOMLIB_OK};
+	DomThread thread;
+	if (!thread.tryStart (ComputeCall<View>::run, &call)) return DOMLIB_ENOMEM;
+	thread.join();
+	return call.status;
+}
+
+int domlib_compute (domlib_graph *graph, int method, domlib_workspace *workspace, int *idom) {
+	if (!graph || !idom) return DOMLIB_EINVAL;
+	if (method<0 || method>=DominatorGraph::DM_METHODS) return DOMLIB_EMETHOD;
+	return compute (graph->g, graph->g.getSource(), method, workspace, idom);
+}
+
+
+/*---------------------------------------------------------------
+ | caller's graphs (dgraph_view.h): the csr arrays are checked as
+ | in domlib_graph_from_csr; callbacks cannot be
+ *--------------------------------------------------------------*/
+
+static bool validCSR (int n, const int *first, const int *adj) {
+	if (!first) return false;
+	for (int v=1; v<=n; v++) {
+		if (first[v]<0 || first[v+1]<first[v]) return false;
+	}
+	if (first[n+1]>first[1] && !adj) return false;
+	for (int i=first[1]; i<first[n+1]; i++) {
+		if (adj[i]<1 || adj[i]>n) return false;
+	}
+	return true;
+}
+
+int domlib_compute_csr (int n, int source, const int *out_first, const int *out_adj, const int *in_first, const int *in_adj,
+                        int method, domlib_workspace *workspace, int *idom) {
+	if (n<1 || source<1 || source>n || !idom) return DOMLIB_EINVAL;
+	if (!validCSR (n, out_first, out_adj) || !validCSR (n, in_first, in_adj)) return DOMLIB_EINVAL;
+	if (method<0 || method>=DominatorGraph::DM_METHODS) return DOMLIB_EMETHOD;
+	CSRView view (n, out_first, out_adj, in_first, in_adj);
+	return compute (view, source, method, workspace, idom);
+}
+
+int domlib_compute_view (int n, int source, domlib_neighbors out, domlib_neighbors in, void *context,
+                         int method, domlib_workspace *workspace, int *idom) {
+	if (n<1 || source<1 || source>n || !out || !in || !idom) return DOMLIB_EINVAL;
+	if (method<0 || method>=DominatorGraph::DM_METHODS) return DOMLIB_EMETHOD;
+	CallbackView view (n, out, in, context);
+	return compute (view, source, method, workspace, idom);
+}
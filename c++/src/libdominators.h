@@ -0,0 +1,123 @@
+/**********************************************************
+ *
+ * libdominators - C interface to the dominator algorithms
+ * - build with "make libdominators.a" or
+ *   "make libdominators.so"; the library has the graph,
+ *   the algorithms and the memory layer, but not dom's
+ *   driver (series, timing, cache, server)
+ * - vertices are numbered 1..n; idom arrays have n+1
+ *   entries (idom[0] is unused), idom[source] = source
+ *   and idom[v] = 0 for vertices unreachable from it
+ * - no function exits the process or prints anything:
+ *   all of them return a status (DOMLIB_OK or an error)
+ * - a workspace keeps the scratch arrays of the algorithms
+ *   between calls; after the first call on the largest
+ *   graph, computing with it allocates no memory
+ * - graphs and workspaces may be used by one thread at a
+ *   time; different threads need different ones
+ * - the methods recurse once per tree level: the compute
+ *   functions run graphs of more than 1024 vertices on a
+ *   thread of their own with a large stack (outside
+ *   Windows), so a caller's stack of 256 KB is enough
+ *
+ **********************************************************/
+
+#ifndef libdominators_h
+#define libdominators_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DOMLIB_VERSION 2
+
+typedef struct domlib_graph domlib_graph;
+typedef struct domlib_workspace domlib_workspace;
+
+//status codes
+enum {
+	DOMLIB_OK = 0,
+	DOMLIB_EINVAL,  //bad argument (sizes, source, arc out of range, NULL pointer)
+	DOMLIB_ENOMEM,  //out of memory
+	DOMLIB_EFILE,   //file cannot be opened or parsed
+	DOMLIB_EMETHOD  //unknown method
+};
+
+//flags for graph creation
+enum {
+	DOMLIB_REVERSE = 1,  //reverse every arc (postdominators)
+	DOMLIB_SIMPLIFY = 2  //remove duplicate arcs
+};
+
+int domlib_version (void);
+const char *domlib_strerror (int status);
+
+/*---------------------------------------------------------------
+ | methods: names as in dom ("ibfs", "idfs", "lt", "slt", "snca",
+ | "dag", "snca-pf", "slt-pf", "ibfs-do", "bitset", and the link-eval
+ | variants "slt-halve", "slt-split", "lt-halve", "lt-split",
+ | "snca-halve", "snca-split", "snca-sized", "snca-sized-halve",
+ | "snca-sized-split"); domlib_method returns a code for
+ | domlib_compute, or -1 if the name is unknown
+ *--------------------------------------------------------------*/
+int domlib_method_count (void);
+const char *domlib_method_name (int method);
+int domlib_method (const char *name);
+
+/*----------------------------------------------------------------
+ | graphs (the library keeps its own copy of the input):
+ | - from m arcs: arcs[2i] -> arcs[2i+1]
+ | - from a CSR: the out-neighbors of v are adj[first[v]] up to
+ |   adj[first[v+1]-1]; first has n+2 entries (first[0] unused)
+ | - from a DIMACS file ("p n m source sink", "a v w" lines); with
+ |   DOMLIB_REVERSE the sink becomes the source
+ *---------------------------------------------------------------*/
+int domlib_graph_from_arcs (int n, int m, int source, const int *arcs, int flags, domlib_graph **graph);
+int domlib_graph_from_csr (int n, int source, const int *first, const int *adj, int flags, domlib_graph **graph);
+int domlib_graph_from_dimacs (const char *filename, int flags, domlib_graph **graph);
+void domlib_graph_destroy (domlib_graph *graph);
+
+int domlib_graph_vertices (const domlib_graph *graph);
+int domlib_graph_arcs (const domlib_graph *graph); //after duplicates are removed
+int domlib_graph_source (const domlib_graph *graph);
+
+/*------------------------------------------------------------------
+ | workspaces: created empty, they grow to what the largest graph
+ | computed with them needs
+ *-----------------------------------------------------------------*/
+int domlib_workspace_create (domlib_workspace **workspace);
+void domlib_workspace_destroy (domlib_workspace *workspace);
+size_t domlib_workspace_bytes (const domlib_workspace *workspace);
+
+/*-------------------------------------------------------------------
+ | immediate dominators of graph (from its source) into idom[0..n];
+ | workspace may be NULL (scratch arrays are then allocated and
+ | freed by the call); a call that fails frees its scratch arrays
+ *------------------------------------------------------------------*/
+int domlib_compute (domlib_graph *graph, int method, domlib_workspace *workspace, int *idom);
+
+/*-------------------------------------------------------------------
+ | immediate dominators of a graph the caller keeps, without copying
+ | it (methods "ibfs", "idfs", "lt", "slt" and "snca" only; others
+ | return DOMLIB_EMETHOD):
+ | - csr: out-neighbors as in domlib_graph_from_csr, and the same for
+ |   the in-neighbors (in_first/in_adj); every arc must be in both
+ | - view: out(context, v, &list) points list to the out-neighbors of
+ |   v and returns how many there are (in: the in-neighbors); lists
+ |   must stay valid during the call, and are not checked
+ | Reversing (postdominators) means swapping the two directions.
+ *------------------------------------------------------------------*/
+typedef int (*domlib_neighbors) (void *context, int v, const int **list);
+
+int domlib_compute_csr (int n, int source, const int *out_first, const int *out_adj, const int *in_first, const int *in_adj,
+                        int method, domlib_workspace *workspace, int *idom);
+int domlib_compute_view (int n, int source, domlib_neighbors out, domlib_neighbors in, void *context,
+                         int method, domlib_workspace *workspace, int *idom);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,290 @@
+/*************************************
+ *
+ * MemPolicy (page and numa policies)
+ *
+ *************************************/
+
+#include "mem_policy.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+static const char *pnames[MemPolicy::NPAGES] = {"small", "thp", "huge"};
+static const char *nnames[MemPolicy::NNUMA] = {"local", "interleave", "bind"};
+
+MemPolicy::Pages MemPolicy::pages = MemPolicy::SMALL;
+MemPolicy::Numa MemPolicy::numa = MemPolicy::LOCAL;
+int MemPolicy::node = 0;
+long long MemPolicy::nmaps = 0;
+long long MemPolicy::mapbytes = 0;
+long long MemPolicy::nhugetlb = 0;
+long long MemPolicy::nfallback = 0;
+long long MemPolicy::nbindfail = 0;
+long long MemPolicy::live = 0;
+long long MemPolicy::peak = 0;
+bool MemPolicy::throwing = false;
+static thread_local MemArena *arena = NULL;
+
+/*----------------------------------------------------
+ | header in front of every block; 64 bytes keeps the
+ | data aligned to a cache line
+ *---------------------------------------------------*/
+typedef struct BlockHeader {
+	size_t length; //bytes mapped (0 if malloc'ed, ARENABLOCK if in an arena)
+	void *base;    //start of the mapping
+	size_t bytes;  //bytes asked for (live and peak counts)
+	MemArena *owner;           //arena whose overflow list has the block (or NULL)
+	BlockHeader *prev, *next;  //in that list
+} BlockHeader;
+static const size_t HEADER = 64;
+static const size_t HUGEPAGE = 2<<20;
+static const size_t ARENABLOCK = ~(size_t)0;
+
+
+bool MemPolicy::setPages (const char *name) {
+	for (int p=0; p<NPAGES; p++) {
+		if (strcmp(name, pnames[p])==0) {pages = (Pages)p; return true;}
+	}
+	return false;
+}
+
+bool MemPolicy::setNuma (const char *name) {
+	if (strncmp(name, "bind:", 5)==0) {
+		node = atoi (&name[5]);
+		if (node<0 || node>=getNNodes()) return false;
+		numa = BIND;
+		return true;
+	}
+	for (int p=0; p<NNUMA; p++) {
+		if (p!=BIND && strcmp(name, nnames[p])==0) {numa = (Numa)p; return true;}
+	}
+	return false;
+}
+
+
+/*---------------------------------------------------------
+ | number of online nodes (from sysfs: "0" or "0-1" etc.)
+ *--------------------------------------------------------*/
+
+int MemPolicy::getNNodes () {
+	int nnodes = 1;
+#ifdef __linux__
+	FILE *file = fopen ("/sys/devices/system/node/online", "r");
+	if (file) {
+		int a, b;
+		int k = fscanf (file, "%d-%d", &a, &b);
+		if (k==2) nnodes = b+1;
+		else if (k==1) nnodes = a+1;
+		fclose (file);
+	}
+#endif
+	return nnodes;
+}
+
+
+/*--------------------------------------------------------------
+ | maps a block of at least 'bytes' bytes, aligned to 2 MB, and
+ | applies the page and numa policies before it is first touched
+ *-------------------------------------------------------------*/
+
+void *MemPolicy::map (size_t bytes) {
+#ifdef __linux__
+	size_t length = ((bytes + HUGEPAGE - 1) / HUGEPAGE) * HUGEPAGE;
+	char *base = NULL;
+
+	if (pages==HUGETLB) {
+		void *p = mmap (NULL, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+		if (p!=MAP_FAILED) {
+			base = (char *)p;
+			__sync_fetch_and_add (&nhugetlb, 1);
+		} else {
+			if (__sync_fetch_and_add (&nfallback, 1)==0) fprintf (stderr, "WARNING: no explicit huge pages available; using transparent huge pages.\n");
+		}
+	}
+
+	if (!base) {
+		//over-allocate and trim so that the block starts at a 2 MB boundary
+		void *p = mmap (NULL, length + HUGEPAGE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if (p==MAP_FAILED) return NULL;
+		char *start = (char *)p;
+		char *aligned = (char *)(((size_t)start + HUGEPAGE - 1) & ~(HUGEPAGE - 1));
+		if (aligned>start) munmap (start, aligned-start);
+		size_t tail = (start + length + HUGEPAGE) - (aligned + length);
+		if (tail) munmap (aligned + length, tail);
+		base = aligned;
+		madvise (base, length, (pages==SMALL) ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+	}
+
+	if (numa!=LOCAL) {
+		unsigned long mask[16];
+		memset (mask, 0, sizeof(mask));
+		int nnodes = getNNodes();
+		int maxnode = 8*sizeof(mask);
+		if (numa==BIND) mask[node/(8*sizeof(long))] |= 1UL << (node%(8*sizeof(long)));
+		else for (int i=0; i<nnodes && i<maxnode; i++) mask[i/(8*sizeof(long))] |= 1UL << (i%(8*sizeof(long)));
+		int mode = (numa==BIND) ? MPOL_BIND : MPOL_INTERLEAVE;
+		if (syscall (SYS_mbind, base, length, mode, mask, maxnode, 0)!=0) __sync_fetch_and_add (&nbindfail, 1);
+	}
+
+	BlockHeader *h = (BlockHeader *)base;
+	h->length = length;
+	h->base = base;
+	//blocks may be mapped concurrently (e.g., by the series loader)
+	__sync_fetch_and_add (&nmaps, 1);
+	__sync_fetch_and_add (&mapbytes, (long long)length);
+	return base;
+#else
+	return NULL;
+#endif
+}
+
+
+void *MemPolicy::allocate (size_t bytes) {
+	MemArena *a = arena;
+	if (a) {
+		size_t size = ((bytes + 2*HEADER - 1) / HEADER) * HEADER; //header included; keeps blocks aligned
+		a->needed += size;
+		if (a->used + size <= a->capacity) {
+			BlockHeader *h = (BlockHeader *)(a->base + a->used);
+			h->length = ARENABLOCK;
+			h->base = NULL;
+			a->used += size;
+			return (char *)h + HEADER;
+		}
+	}
+
+	char *block = NULL;
+	if (!isDefault() && bytes>=MINBYTES) block = (char *)map (bytes + HEADER);
+	if (!block) {
+		block = (char *)malloc (bytes + HEADER);
+		if (!block) {
+			if (throwing) throw std::bad_alloc();
+			fprintf (stderr, "ERROR: out of memory (%lu bytes).\n", (unsigned long)bytes);
+			exit(-1);
+		}
+		((BlockHeader *)block)->length = 0;
+		((BlockHeader *)block)->base = block;
+	}
+	BlockHeader *h = (BlockHeader *)block;
+	h->bytes = bytes;
+	h->owner = a;
+	if (a) { //overflow: freed by the arena unless released first
+		h->prev = NULL;
+		h->next = (BlockHeader *)a->overflow;
+		if (h->next) h->next->prev = h;
+		a->overflow = h;
+	}
+	count ((long long)bytes);
+	return block + HEADER;
+}
+
+
+void MemPolicy::release (void *p) {
+	if (!p) return;
+	BlockHeader *h = (BlockHeader *)((char *)p - HEADER);
+	if (h->length==ARENABLOCK) return; //freed with the arena
+	if (h->owner) {
+		if (h->prev) h->prev->next = h->next;
+		else h->owner->overflow = h->next;
+		if (h->next) h->next->prev = h->prev;
+	}
+	count (-(long long)h->bytes);
+#ifdef __linux__
+	if (h->length) {
+		munmap (h->base, h->length);
+		return;
+	}
+#endif
+	free (h->base);
+}
+
+
+/*-----------------------------------------------------------
+ | live and peak bytes of the blocks outside arenas (blocks
+ | may come and go concurrently, so the counts are atomic)
+ *----------------------------------------------------------*/
+
+void MemPolicy::count (long long bytes) {
+	long long now = __sync_add_and_fetch (&live, bytes);
+	long long old = peak;
+	while (now > old) {
+		long long seen = __sync_val_compare_and_swap (&peak, old, now);
+		if (seen==old) break;
+		old = seen;
+	}
+}
+
+long long MemPolicy::resetPeak () {
+	long long now = __sync_add_and_fetch (&live, 0);
+	peak = now;
+	return now;
+}
+
+
+MemArena *MemPolicy::setArena (MemArena *a) {
+	MemArena *previous = arena;
+	arena = a;
+	return previous;
+}
+
+
+/*-------------------------------------------------------------
+ | arenas: plain malloc'ed blocks (they are meant to be reused,
+ | so the page policy would buy little); reset() invalidates 
+ | every block handed out since the previous reset()
+ *------------------------------------------------------------*/
+
+MemArena::~MemArena() {
+	freeOverflow();
+	if (base) free (base);
+}
+
+void MemArena::freeOverflow () {
+	while (overflow) MemPolicy::release ((char *)overflow + HEADER);
+}
+
+void MemArena::reset () {
+	freeOverflow();
+	if (needed > capacity) {
+		if (base) free (base);
+		base = (char *)malloc (needed);
+		capacity = base ? needed : 0;
+	}
+	used = needed = 0;
+}
+
+
+/*----------------------------------------------------------
+ | policy and mapping counts, plus the huge pages actually
+ | backing anonymous memory right now (from the kernel)
+ *---------------------------------------------------------*/
+
+void MemPolicy::output (FILE *file) {
+	fprintf (file, "pages %s\n", pnames[pages]);
+	if (numa==BIND) fprintf (file, "numa bind:%d\n", node);
+	else fprintf (file, "numa %s\n", nnames[numa]);
+	fprintf (file, "numanodes %d\n", getNNodes());
+	fprintf (file, "mapblocks %lld\n", nmaps);
+	fprintf (file, "mapbytes %lld\n", mapbytes);
+	fprintf (file, "hugetlbblocks %lld\n", nhugetlb);
+	fprintf (file, "hugetlbfallbacks %lld\n", nfallback);
+	if (nbindfail) fprintf (file, "mbindfailures %lld\n", nbindfail);
+#ifdef __linux__
+	FILE *smaps = fopen ("/proc/self/smaps_rollup", "r");
+	if (smaps) {
+		char line[256];
+		long long kb;
+		while (fgets (line, sizeof(line), smaps)) {
+			if (sscanf (line, "AnonHugePages: %lld kB", &kb)==1) fprintf (file, "anonhugekb %lld\n", kb);
+		}
+		fclose (smaps);
+	}
+#endif
+}
@@ -0,0 +1,101 @@
+/**********************************************************
+ *
+ * MemPolicy
+ * - allocation layer for the graph and for the scratch
+ *   arrays of the algorithms
+ * - page policy: small (4 KB pages, plain malloc), thp
+ *   (2 MB-aligned anonymous mappings with MADV_HUGEPAGE),
+ *   or huge (explicit MAP_HUGETLB pages; falls back to thp
+ *   when none are reserved)
+ * - numa policy: local (first touch), interleave (across
+ *   all online nodes), or bind to a single node
+ * - only arrays of at least MINBYTES are mapped; smaller
+ *   ones (and everything outside Linux) use malloc
+ * - every block has a 64-byte header with its size, so
+ *   release() needs only the pointer
+ * - a thread may install a MemArena: its blocks then come
+ *   from the arena (release() is a no-op for them) until it
+ *   is full; the arena records how much it would have
+ *   needed, so that it can grow before the next use
+ * - blocks allocated past a full arena are linked to it
+ *   until released; reset() and the destructor free those
+ *   still there, so a computation cut short by bad_alloc
+ *   leaks nothing (an empty arena only does this tracking)
+ * - live and peak bytes (of blocks outside arenas) are
+ *   counted, so that callers can tell what a computation
+ *   allocated at its worst
+ * - allocation failures exit the process, or throw
+ *   std::bad_alloc if setThrow(true) (the library does)
+ *
+ **********************************************************/
+
+#ifndef mem_policy_h
+#define mem_policy_h
+
+#include <stdio.h>
+#include <stddef.h>
+
+class MemArena {
+	friend class MemPolicy;
+	private:
+		char *base;
+		size_t capacity; //bytes in base
+		size_t used;     //bytes handed out since the last reset()
+		size_t needed;   //bytes the current round asked for (including overflow)
+		void *overflow;  //blocks allocated past capacity, not yet released (a list)
+
+		void freeOverflow ();
+
+	public:
+		MemArena() {base = NULL; capacity = used = needed = 0; overflow = NULL;}
+		~MemArena();
+		void reset (); //forget all blocks (freeing overflow); grows to the last round's needs first
+		size_t getCapacity() const {return capacity;}
+};
+
+class MemPolicy {
+	public:
+		typedef enum {SMALL, THP, HUGETLB, NPAGES} Pages;
+		typedef enum {LOCAL, INTERLEAVE, BIND, NNUMA} Numa;
+		static const size_t MINBYTES = 1<<18;
+
+	private:
+		static Pages pages;
+		static Numa numa;
+		static int node;            //for BIND
+		static long long nmaps;     //number of mapped blocks
+		static long long mapbytes;  //total bytes mapped
+		static long long nhugetlb;  //blocks backed by explicit huge pages
+		static long long nfallback; //explicit huge page requests that failed
+		static long long nbindfail; //mbind calls that failed
+		static bool throwing;       //throw std::bad_alloc instead of exiting?
+		static long long live;      //bytes in blocks not yet released
+		static long long peak;      //largest value of live since the last resetPeak()
+
+		static void *map (size_t bytes);
+		static void count (long long bytes); //live += bytes
+
+	public:
+		static bool setPages (const char *name); //small, thp, or huge
+		static bool setNuma (const char *name);  //local, interleave, or bind:<node>
+		static bool isDefault () {return pages==SMALL && numa==LOCAL;}
+		static int getNNodes ();
+
+		static void *allocate (size_t bytes);
+		static void release (void *p);
+
+		static MemArena *setArena (MemArena *arena); //for the calling thread; returns the previous one
+		static void setThrow (bool t) {throwing = t;}
+
+		static long long getLive () {return live;}
+		static long long getPeak () {return peak;}
+		static long long resetPeak (); //peak becomes live (which it returns)
+
+		//print "name value" lines (policy, mapping counts, huge page usage)
+		static void output (FILE *file);
+};
+
+template <class T> inline T *mpNew (size_t k) {return (T *)MemPolicy::allocate (k*sizeof(T));}
+template <class T> inline void mpDelete (T *p) {MemPolicy::release ((void *)p);}
+
+#endif
@@ -0,0 +1,130 @@
+/*************************************
+ *
+ * PerfCounters (hardware counters)
+ *
+ *************************************/
+
+#include "perf_counters.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *cnames[PerfCounters::NCOUNTERS] = {
+	"cycles",
+	"instructions",
+	"llcmisses",
+	"dtlbmisses",
+	"branchmisses"
+};
+
+const char *PerfCounters::getName (int c) {return cnames[c];}
+
+PerfCounters::PerfCounters() {
+	running = false;
+	for (int c=0; c<NCOUNTERS; c++) fd[c] = -1;
+	reset();
+}
+
+PerfCounters::~PerfCounters() {close();}
+
+void PerfCounters::reset() {
+	for (int c=0; c<NCOUNTERS; c++) value[c] = 0;
+}
+
+int PerfCounters::getNAvailable () const {
+	int count = 0;
+	for (int c=0; c<NCOUNTERS; c++) if (isAvailable(c)) count++;
+	return count;
+}
+
+void PerfCounters::output (FILE *file, int runs) const {
+	for (int c=0; c<NCOUNTERS; c++) {
+		if (!isAvailable(c)) continue;
+		fprintf (file, "%s %lld\n", cnames[c], value[c]);
+		if (runs>0) fprintf (file, "%sr %.2f\n", cnames[c], (double)value[c]/(double)runs);
+	}
+	if (isAvailable(CYCLES) && isAvailable(INSTRUCTIONS) && value[CYCLES]>0) {
+		fprintf (file, "ipc %.4f\n", (double)value[INSTRUCTIONS]/(double)value[CYCLES]);
+	}
+}
+
+#ifdef __linux__
+
+bool PerfCounters::open() {
+	const unsigned long long miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	unsigned int type[NCOUNTERS];
+	unsigned long long config[NCOUNTERS];
+
+	type[CYCLES] = PERF_TYPE_HARDWARE;       config[CYCLES] = PERF_COUNT_HW_CPU_CYCLES;
+	type[INSTRUCTIONS] = PERF_TYPE_HARDWARE; config[INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS;
+	type[LLCMISSES] = PERF_TYPE_HW_CACHE;    config[LLCMISSES] = PERF_COUNT_HW_CACHE_LL | miss;
+	type[DTLBMISSES] = PERF_TYPE_HW_CACHE;   config[DTLBMISSES] = PERF_COUNT_HW_CACHE_DTLB | miss;
+	type[BRANCHMISSES] = PERF_TYPE_HARDWARE; config[BRANCHMISSES] = PERF_COUNT_HW_BRANCH_MISSES;
+
+	bool any = false;
+	for (int c=0; c<NCOUNTERS; c++) {
+		struct perf_event_attr attr;
+		memset (&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type[c];
+		attr.config = config[c];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attr.inherit = 1; //threads created later count too (reads and ioctls cover them)
+
+		//counters are opened independently (not as a group) so that 
+		//the ones the hardware lacks do not disable the others
+		fd[c] = (int)syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fd[c]>=0) any = true;
+	}
+	return any;
+}
+
+void PerfCounters::close() {
+	for (int c=0; c<NCOUNTERS; c++) {
+		if (fd[c]>=0) ::close (fd[c]);
+		fd[c] = -1;
+	}
+}
+
+void PerfCounters::start() {
+	for (int c=0; c<NCOUNTERS; c++) {
+		if (fd[c]<0) continue;
+		ioctl (fd[c], PERF_EVENT_IOC_RESET, 0);
+		ioctl (fd[c], PERF_EVENT_IOC_ENABLE, 0);
+	}
+	running = true;
+}
+
+void PerfCounters::stop() {
+	if (!running) return;
+	for (int c=0; c<NCOUNTERS; c++) {
+		if (fd[c]<0) continue;
+		ioctl (fd[c], PERF_EVENT_IOC_DISABLE, 0);
+	}
+	for (int c=0; c<NCOUNTERS; c++) {
+		unsigned long long data[3]; //value, time enabled, time running
+		if (fd[c]<0) continue;
+		if (read (fd[c], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+		if (data[2]==0) continue; //never scheduled
+		if (data[2]<data[1]) value[c] += (long long)((double)data[0] * (double)data[1] / (double)data[2]);
+		else value[c] += (long long)data[0];
+	}
+	running = false;
+}
+
+#else
+
+bool PerfCounters::open() {return false;}
+void PerfCounters::close() {}
+void PerfCounters::start() {running = true;}
+void PerfCounters::stop() {running = false;}
+
+#endif
@@ -0,0 +1,58 @@
+/**********************************************************
+ *
+ * PerfCounters
+ * - hardware performance counters (cycles, instructions,
+ *   last-level cache misses, dTLB misses, branch misses)
+ *   for the calling thread and every thread it creates
+ *   after open() (OpenMP workers included, if open() comes
+ *   before the first parallel region), read through
+ *   perf_event_open
+ * - counts are accumulated over start()/stop() pairs and 
+ *   scaled when the kernel multiplexes the counters
+ * - only available on Linux; elsewhere (or if the kernel
+ *   refuses, e.g. because of perf_event_paranoid) every
+ *   counter is reported as unavailable
+ *
+ **********************************************************/
+
+#ifndef perf_counters_h
+#define perf_counters_h
+
+#include <stdio.h>
+
+class PerfCounters {
+	public:
+		enum {
+			CYCLES,
+			INSTRUCTIONS,
+			LLCMISSES,
+			DTLBMISSES,
+			BRANCHMISSES,
+			NCOUNTERS
+		};
+
+	private:
+		int fd[NCOUNTERS];            //file descriptors (-1 if unavailable)
+		long long value[NCOUNTERS];   //accumulated (scaled) counts
+		bool running;
+
+	public:
+		PerfCounters();
+		~PerfCounters();
+
+		bool open();   //open all counters; true iff at least one is available
+		void close();
+		void start();  //start counting (values keep accumulating)
+		void stop();   //stop counting and add the counts to the totals
+		void reset();  //zero the totals
+
+		bool isAvailable (int c) const {return fd[c]>=0;}
+		int getNAvailable () const;
+		long long getValue (int c) const {return value[c];}
+		static const char *getName (int c);
+
+		//print "name value" lines; per-run averages use suffix 'r'
+		void output (FILE *file, int runs) const;
+};
+
+#endif
@@ -116,6 +116,23 @@ double RFWTimer::getUserTime() {
 #endif
 
 
+//------------
+// RFW_STEADY
+//------------
+
+#ifdef RFW_STEADY
+
+void RFWTimer::startTiming() {clock_gettime(CLOCK_MONOTONIC, &start_time);}
+
+double RFWTimer::getElapsedTime() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start_time.tv_sec) + 1e-9 * (double)(now.tv_nsec - start_time.tv_nsec);
+}
+
+#endif
+
+
 /*************
  *RFW_HTIME
  *************/
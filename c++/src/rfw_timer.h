@@ -2,13 +2,18 @@
  *
  * RFWTimer
  * - measures running time in second
- * - supports three different facilities (clock, rusage, 
- *   and htime); define RFW_USAGE, RFW_CLOCK, or RFW_HTIME
+ * - supports four different facilities (clock, rusage, 
+ *   htime, and steady); define RFW_USAGE, RFW_CLOCK, 
+ *   RFW_HTIME, or RFW_STEADY
  * - if none is the defined, a very crude heuristic is used
  *   to determine which one is to be used; don't rely on
  *   each to much
  *
  * log:
+ *   Oct 18, 2026:
+ *     - RFW_STEADY: wall-clock time from the monotonic clock
+ *       (clock_gettime), nanosecond resolution
+ *
  *   Mar 24, 2003:
  *     - some formatting 
  *
@@ -28,6 +33,7 @@
 #ifndef RFW_RUSAGE
 #ifndef RFW_CLOCK
 #ifndef RFW_HTIME
+#ifndef RFW_STEADY
 
 #ifdef WIN32
 	#define RFW_CLOCK
@@ -43,6 +49,7 @@
 #endif
 #endif
 #endif 
+#endif
 
 #ifdef RFW_RUSAGE
 #include <sys/time.h>
@@ -58,6 +65,10 @@
 #include <time.h>
 #endif
 
+#ifdef RFW_STEADY
+#include <time.h>
+#endif
+
 //------------------
 // the class itself
 //------------------
@@ -80,6 +91,10 @@ class RFWTimer {
 		struct rusage ru;
 		struct timeval start_time, end_time, sample_time;
 	#endif
+
+	#ifdef RFW_STEADY
+		struct timespec start_time;
+	#endif
 		
 		void setBaseTime (double bt); 
 
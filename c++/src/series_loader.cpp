@@ -0,0 +1,425 @@
+/*************************************
+ *
+ * SeriesLoader (see series_loader.h)
+ *
+ *************************************/
+
+#include "series_loader.h"
+#include "rfw_timer.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifndef WIN32
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+//per-file state during a load
+struct SeriesLoader::FileInfo {
+	char *name;
+	char *cachename;      //NULL if there is no cache
+	long long size, mtime; //of the input (mtime in nanoseconds)
+	int n, m, onarcs, src; //m: exact if hit, upper bound otherwise
+	int slot;             //position in the list (-1 if dropped)
+	size_t offset;        //of its slice of the arena
+	bool hit;             //found in the cache?
+};
+
+SeriesLoader::SeriesLoader() {
+	nfiles = nignored = 0;
+	arena = 0;
+	tlist = theaders = tbuild = 0.0;
+	cachedir = NULL;
+	nhits = nmisses = nwrites = 0;
+}
+
+
+/*------------------------------------------------------------
+ | graph size and source (sink if reverse) from the 'p' line
+ *-----------------------------------------------------------*/
+
+bool SeriesLoader::readHeader (const char *filename, bool reverse, int &n, int &m, int &src) {
+	FILE *input = fopen (filename, "r");
+	if (!input) {
+		fprintf (stderr, "Error opening file \"%s\".\n", filename);
+		exit(-1);
+	}
+	int snk;
+	bool ok = (fscanf (input, "p %d %d %d %d", &n, &m, &src, &snk)==4);
+	fclose (input);
+	if (reverse) src = snk;
+	return ok;
+}
+
+
+/*------------------------------------------------------------------
+ | reads the whole file and parses the 'a' lines by hand (comment 
+ | lines are skipped); returns the number of arcs (at most m) read;
+ | parseArcText does the parsing, on a zero-terminated DIMACS text
+ *-----------------------------------------------------------------*/
+
+static inline int parseInt (const char *&s) {
+	while (*s==' ' || *s=='\t') s++;
+	int x = 0;
+	while (*s>='0' && *s<='9') x = 10*x + (*(s++) - '0');
+	return x;
+}
+
+static inline void skipLine (const char *&s) {
+	while (*s && *s!='\n') s++;
+	if (*s) s++;
+}
+
+int SeriesLoader::parseArcs (const char *filename, bool reverse, int m, int *arclist) {
+	FILE *input = fopen (filename, "rb");
+	if (!input) {
+		fprintf (stderr, "Error opening file \"%s\".\n", filename);
+		exit(-1);
+	}
+	fseek (input, 0, SEEK_END);
+	long size = ftell (input);
+	fseek (input, 0, SEEK_SET);
+	char *buffer = new char [size+1];
+	size = (long)fread (buffer, 1, size, input);
+	buffer[size] = 0;
+	fclose (input);
+	int k = parseArcText (buffer, reverse, m, arclist);
+	delete [] buffer;
+	return k;
+}
+
+int SeriesLoader::parseArcText (const char *s, bool reverse, int m, int *arclist) {
+	while (*s && *s!='p') skipLine (s); 
+	skipLine (s); //the header (read by the caller)
+
+	int k = 0;
+	while (*s && k<m) {
+		if (*s=='a') {
+			s++;
+			int a = parseInt (s);
+			int b = parseInt (s);
+			if (reverse) {int t = a; a = b; b = t;}
+			arclist[2*k] = a;
+			arclist[2*k+1] = b;
+			k++;
+		} else if (*s!='c' && *s!='n' && *s!='\n' && *s!='\r') break; //'n': vertex weights (unused)
+		skipLine (s);
+	}
+	return k;
+}
+
+
+/*---------------------------------------------------------------
+ | parses a file whose header has already been read and builds 
+ | the graph (in storage, if not NULL)
+ *--------------------------------------------------------------*/
+
+void SeriesLoader::parseGraph (const char *filename, bool reverse, bool simplify, int n, int m, int src, DominatorGraph &g, char *storage, bool own) {
+	int *arclist = new int [2*(size_t)m + 2];
+	int k = parseArcs (filename, reverse, m, arclist);
+	for (int i=0; i<2*k; i++) {
+		if (arclist[i]<1 || arclist[i]>n) {
+			fprintf (stderr, "Error: arc out of range (%s).\n", filename);
+			exit(-1);
+		}
+	}
+	g.buildGraph (n, k, src, arclist, simplify, storage, own);
+	delete [] arclist;
+}
+
+bool SeriesLoader::readGraph (const char *filename, bool reverse, bool simplify, bool compress, DominatorGraph &g) {
+	int n, m, src;
+	if (!readHeader (filename, reverse, n, m, src)) {
+		fprintf (stderr, "Error reading graph size (%s).\n", filename);
+		exit(-1);
+	}
+	if (src==0) return false;
+	parseGraph (filename, reverse, simplify, n, m, src, g, NULL, false);
+	if (compress) g.compressArcs();
+	return true;
+}
+
+
+/*-----------------------------------------
+ | names in a list (separated by spaces)
+ *----------------------------------------*/
+
+char **SeriesLoader::readNames (const char *listname, int &count) {
+	FILE *input = fopen (listname, "r");
+	if (!input) {
+		fprintf (stderr, "Error opening file \"%s\".\n", listname);
+		exit(-1);
+	}
+	int capacity = 64;
+	char **names = (char **)malloc (capacity * sizeof(char *));
+	char buffer[1024];
+	count = 0;
+	while (fscanf (input, "%1023s", buffer)==1) {
+		if (count==capacity) {
+			capacity *= 2;
+			names = (char **)realloc (names, capacity * sizeof(char *));
+		}
+		names[count++] = strdup (buffer);
+	}
+	fclose (input);
+	return names;
+}
+
+void SeriesLoader::freeNames (char **names, int count) {
+	for (int i=0; i<count; i++) free (names[i]);
+	free (names);
+}
+
+
+/*--------------------------------------------------------------------
+ | Cache files: a header, the input path (padded to 8 bytes), and the 
+ | flat CSR image of the graph (see DominatorGraph::writeCSR). Files
+ | are named after a hash of the absolute path and the flags; the 
+ | path stored in the file resolves collisions.
+ *-------------------------------------------------------------------*/
+
+typedef struct {
+	char magic[8];         //"DOMCSR1"
+	long long size, mtime; //of the input
+	int reverse, simplify;
+	int n, narcs, onarcs, source;
+	int pathlen;           //bytes in the path (no terminator)
+	int unused;
+} CacheHeader;
+
+static const char CACHEMAGIC[8] = "DOMCSR1";
+
+static inline size_t pad8 (size_t bytes) {return (bytes + 7) & ~(size_t)7;}
+
+#ifndef WIN32
+
+bool SeriesLoader::probeCache (const char *filename, bool reverse, bool simplify, FileInfo &info) {
+	struct stat st;
+	if (stat (filename, &st)!=0) return false;
+	info.size = (long long)st.st_size;
+	info.mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + (long long)st.st_mtim.tv_nsec;
+
+	char path[PATH_MAX];
+	if (!realpath (filename, path)) return false;
+	int pathlen = (int)strlen (path);
+
+	//FNV-1a of the path and the flags
+	unsigned long long h = 14695981039346656037ULL;
+	for (int i=0; i<pathlen; i++) {h ^= (unsigned char)path[i]; h *= 1099511628211ULL;}
+	h ^= (unsigned long long)((reverse ? 2 : 0) + (simplify ? 1 : 0)); h *= 1099511628211ULL;
+	size_t len = strlen (cachedir) + 32;
+	info.cachename = (char *)malloc (len);
+	snprintf (info.cachename, len, "%s/%016llx.csr", cachedir, h);
+
+	FILE *input = fopen (info.cachename, "rb");
+	if (!input) return false;
+	CacheHeader header;
+	char stored[PATH_MAX];
+	bool ok = fread (&header, sizeof(header), 1, input)==1
+	       && memcmp (header.magic, CACHEMAGIC, 8)==0
+	       && header.size==info.size && header.mtime==info.mtime
+	       && header.reverse==(int)reverse && header.simplify==(int)simplify
+	       && header.pathlen==pathlen
+	       && fread (stored, 1, pathlen, input)==(size_t)pathlen
+	       && memcmp (stored, path, pathlen)==0
+	       && fstat (fileno (input), &st)==0
+	       && (size_t)st.st_size==sizeof(header) + pad8 (pathlen) + DominatorGraph::getCSRSize (header.n, header.narcs);
+	fclose (input);
+	if (!ok) return false;
+
+	info.n = header.n;
+	info.m = header.narcs;
+	info.onarcs = header.onarcs;
+	info.src = header.source;
+	return true;
+}
+
+bool SeriesLoader::readCache (FileInfo &info, DominatorGraph &g, char *storage, bool own) {
+	int fd = open (info.cachename, O_RDONLY);
+	if (fd<0) return false;
+	struct stat st;
+	size_t skip = 0;
+	bool ok = (fstat (fd, &st)==0) && ((size_t)st.st_size >= sizeof(CacheHeader));
+	void *p = MAP_FAILED;
+	if (ok) {
+		p = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		ok = (p!=MAP_FAILED);
+	}
+	if (ok) {
+		const CacheHeader *header = (const CacheHeader *)p;
+		skip = sizeof(CacheHeader) + pad8 (header->pathlen);
+		ok = ((size_t)st.st_size == skip + DominatorGraph::getCSRSize (info.n, info.m));
+	}
+	if (ok) {
+		madvise (p, st.st_size, MADV_SEQUENTIAL);
+		g.loadCSR (info.n, info.m, info.onarcs, info.src, (const int *)((const char *)p + skip), storage, own);
+	}
+	if (p!=MAP_FAILED) munmap (p, st.st_size);
+	close (fd);
+	return ok;
+}
+
+bool SeriesLoader::writeCache (const FileInfo &info, const DominatorGraph &g, bool reverse, bool simplify) {
+	char path[PATH_MAX];
+	if (!realpath (info.name, path)) return false;
+
+	//written under a temporary name, then renamed: readers never see partial files
+	size_t len = strlen (info.cachename) + 32;
+	char *tmpname = (char *)malloc (len);
+	snprintf (tmpname, len, "%s.%d.tmp", info.cachename, (int)getpid());
+	FILE *output = fopen (tmpname, "wb");
+	if (!output) {free (tmpname); return false;}
+
+	CacheHeader header;
+	memset (&header, 0, sizeof(header));
+	memcpy (header.magic, CACHEMAGIC, 8);
+	header.size = info.size;
+	header.mtime = info.mtime;
+	header.reverse = (int)reverse;
+	header.simplify = (int)simplify;
+	header.n = g.getNVertices();
+	header.narcs = g.getNArcs();
+	header.onarcs = g.getOriginalNArcs();
+	header.source = g.getSource();
+	header.pathlen = (int)strlen (path);
+
+	char zeros[8] = {0,0,0,0,0,0,0,0};
+	bool ok = fwrite (&header, sizeof(header), 1, output)==1
+	       && fwrite (path, 1, header.pathlen, output)==(size_t)header.pathlen
+	       && fwrite (zeros, 1, pad8(header.pathlen) - header.pathlen, output)==pad8(header.pathlen) - header.pathlen
+	       && g.writeCSR (output);
+	ok = (fclose (output)==0) && ok;
+	ok = ok && (rename (tmpname, info.cachename)==0);
+	if (!ok) remove (tmpname);
+	free (tmpname);
+	return ok;
+}
+
+#else
+
+bool SeriesLoader::probeCache (const char *, bool, bool, FileInfo &) {return false;}
+bool SeriesLoader::readCache (FileInfo &, DominatorGraph &, char *, bool) {return false;}
+bool SeriesLoader::writeCache (const FileInfo &, const DominatorGraph &, bool, bool) {return false;}
+
+#endif
+
+
+DominatorGraph *SeriesLoader::load (const char *listname, bool reverse, bool simplify, bool compress, int &count) {
+	RFWTimer timer(true);
+
+	/*-------------------
+	 | list of filenames
+	 *------------------*/
+	char **names = readNames (listname, nfiles);
+	tlist = timer.getTime();
+
+	/*-----------------------------------------------------------
+	 | headers (from the cache or the inputs): drop graphs without
+	 | a source, size the arena
+	 *----------------------------------------------------------*/
+	timer.start();
+	bool cache = (cachedir!=NULL);
+#ifndef WIN32
+	if (cache) {
+		struct stat st;
+		mkdir (cachedir, 0777); //may exist already
+		if (stat (cachedir, &st)!=0 || !S_ISDIR(st.st_mode)) {
+			fprintf (stderr, "WARNING: cannot use cache directory \"%s\".\n", cachedir);
+			cache = false;
+		}
+	}
+#endif
+	FileInfo *info = new FileInfo [nfiles+1];
+
+	int f;
+	#pragma omp parallel for schedule(dynamic,4)
+	for (f=0; f<nfiles; f++) {
+		FileInfo &fi = info[f];
+		fi.name = names[f];
+		fi.cachename = NULL;
+		fi.hit = cache && probeCache (fi.name, reverse, simplify, fi);
+		if (!fi.hit) {
+			if (!readHeader (fi.name, reverse, fi.n, fi.m, fi.src)) {
+				fprintf (stderr, "Error reading graph size (%s).\n", fi.name);
+				exit(-1);
+			}
+		}
+	}
+
+	size_t total = 0;
+	count = nhits = nmisses = nwrites = 0;
+	for (f=0; f<nfiles; f++) {
+		FileInfo &fi = info[f];
+		if (fi.src==0) {fi.slot = -1; continue;}
+		fi.slot = count++;
+		fi.offset = total;
+		total += DominatorGraph::getStorageSize (fi.n, fi.m);
+		if (cache) {
+			if (fi.hit) nhits++;
+			else nmisses++;
+		}
+	}
+	nignored = nfiles - count;
+	arena = total;
+	char *block = (count>0) ? mpNew<char> (total) : NULL;
+	DominatorGraph *glist = new DominatorGraph [count+1];
+	theaders = timer.getTime();
+
+	/*---------------------------------------------------------
+	 | map cached graphs, parse and build (and cache) the others 
+	 | (one file per thread)
+	 *--------------------------------------------------------*/
+	timer.start();
+	#pragma omp parallel for schedule(dynamic,1)
+	for (f=0; f<nfiles; f++) {
+		FileInfo &fi = info[f];
+		int g = fi.slot;
+		if (g<0) continue;
+		if (fi.hit) {
+			if (!readCache (fi, glist[g], block + fi.offset, g==0)) {
+				fprintf (stderr, "Error reading cache file \"%s\" (remove it and try again).\n", fi.cachename);
+				exit(-1);
+			}
+		} else {
+			parseGraph (fi.name, reverse, simplify, fi.n, fi.m, fi.src, glist[g], block + fi.offset, g==0);
+			if (fi.cachename) {
+				if (writeCache (fi, glist[g], reverse, simplify)) __sync_fetch_and_add (&nwrites, 1);
+			}
+		}
+		if (compress) glist[g].compressArcs();
+	}
+	tbuild = timer.getTime();
+	if (cache && nwrites<nmisses) {
+		fprintf (stderr, "WARNING: could not write %d of %d files to cache directory \"%s\".\n", nmisses-nwrites, nmisses, cachedir);
+	}
+
+	for (f=0; f<nfiles; f++) free (info[f].cachename);
+	freeNames (names, nfiles);
+	delete [] info;
+	return glist;
+}
+
+
+void SeriesLoader::output (FILE *file) const {
+	fprintf (file, "loadfiles %d\n", nfiles);
+	fprintf (file, "loadignored %d\n", nignored);
+	fprintf (file, "loadarena %lld\n", arena);
+	fprintf (file, "loadlisttime %.6f\n", tlist);
+	fprintf (file, "loadheadertime %.6f\n", theaders);
+	fprintf (file, "loadbuildtime %.6f\n", tbuild);
+	fprintf (file, "loadtime %.6f\n", getLoadTime());
+	fprintf (file, "loadcache %d\n", (int)(cachedir!=NULL));
+	fprintf (file, "loadcachehits %d\n", nhits);
+	fprintf (file, "loadcachemisses %d\n", nmisses);
+	fprintf (file, "loadcachewrites %d\n", nwrites);
+#ifdef _OPENMP
+	fprintf (file, "loadthreads %d\n", omp_get_max_threads());
+#else
+	fprintf (file, "loadthreads 1\n");
+#endif
+}
@@ -0,0 +1,67 @@
+/**********************************************************
+ *
+ * SeriesLoader
+ * - reads all graphs of a series (a file listing DIMACS
+ *   files) in a single pass over the inputs
+ * - first the headers are read, which is enough to drop
+ *   graphs without a source and to size one arena that 
+ *   holds the adjacency arrays of all graphs
+ * - then every file is parsed (by hand, not fscanf) and
+ *   built into its slice of the arena; with OpenMP, files
+ *   are processed in parallel
+ * - the arena is owned (and freed) by the first graph
+ * - optionally, the built (uncompressed) CSR of every graph
+ *   is kept in a cache directory, one file per input and 
+ *   reverse/simplify combination; a cached graph is used
+ *   (mapped, no parsing) as long as the path, size, and 
+ *   modification time of its input are unchanged
+ *
+ **********************************************************/
+
+#ifndef series_loader_h
+#define series_loader_h
+
+#include "dgraph.h"
+#include <stdio.h>
+
+class SeriesLoader {
+	private:
+		int nfiles;       //files listed
+		int nignored;     //graphs without a source
+		long long arena;  //bytes in the shared arena
+		double tlist, theaders, tbuild; //seconds (wall clock) per step
+		const char *cachedir; //NULL: no cache
+		int nhits, nmisses, nwrites; //cache statistics
+
+		struct FileInfo;
+		static bool readHeader (const char *filename, bool reverse, int &n, int &m, int &src);
+		static int parseArcs (const char *filename, bool reverse, int m, int *arclist);
+		static void parseGraph (const char *filename, bool reverse, bool simplify, int n, int m, int src, DominatorGraph &g, char *storage, bool own);
+		bool probeCache (const char *filename, bool reverse, bool simplify, FileInfo &info);
+		bool readCache (FileInfo &info, DominatorGraph &g, char *storage, bool own);
+		bool writeCache (const FileInfo &info, const DominatorGraph &g, bool reverse, bool simplify);
+
+	public:
+		SeriesLoader();
+		void setCache (const char *dir) {cachedir = dir;} //NULL disables the cache
+
+		//returns an array with the count graphs that have a source
+		DominatorGraph *load (const char *listname, bool reverse, bool simplify, bool compress, int &count);
+
+		//a single graph in its own storage (no cache); false if it has no source
+		static bool readGraph (const char *filename, bool reverse, bool simplify, bool compress, DominatorGraph &g);
+
+		//the (at most m) arcs of a DIMACS text (zero-terminated); returns how many
+		static int parseArcText (const char *text, bool reverse, int m, int *arclist);
+
+		static char **readNames (const char *listname, int &count); //free with freeNames
+		static void freeNames (char **names, int count);
+
+		int getNIgnored() const {return nignored;}
+		int getCacheHits() const {return nhits;}
+		int getCacheMisses() const {return nmisses;}
+		double getLoadTime() const {return tlist + theaders + tbuild;}
+		void output (FILE *file) const; //"name value" lines
+};
+
+#endif
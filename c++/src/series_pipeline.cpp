@@ -0,0 +1,299 @@
+/*************************************
+ *
+ * SeriesPipeline (see series_pipeline.h)
+ *
+ *************************************/
+
+#include "series_pipeline.h"
+#include "series_loader.h"
+#include "rfw_timer.h"
+#include "dom_thread.h"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+struct SeriesPipeline::Item {
+	int index;          //position in the list
+	DominatorGraph *g;  //NULL once computed (or if the graph has no source)
+	int *idom;          //NULL until computed (or if the graph has no source)
+	int n, root;
+	long long bytes;    //counted in the pipeline's memory
+};
+
+
+/*---------------------------------------------------------------
+ | bounded FIFO; pop fails once all producers are done and the 
+ | queue is empty; push and pop return the time they blocked
+ *--------------------------------------------------------------*/
+
+class SeriesPipeline::Queue {
+	private:
+		std::mutex lock;
+		std::condition_variable notfull, notempty;
+		std::deque<Item *> items;
+		size_t capacity;
+		int producers; //still running
+		int peak;
+
+	public:
+		Queue (size_t _capacity, int _producers) : capacity(_capacity), producers(_producers), peak(0) {}
+
+		double push (Item *item) {
+			std::unique_lock<std::mutex> guard (lock);
+			double stall = 0.0;
+			if (items.size()>=capacity) {
+				RFWTimer timer(true);
+				while (items.size()>=capacity) notfull.wait (guard);
+				stall = timer.getTime();
+			}
+			items.push_back (item);
+			if ((int)items.size()>peak) peak = (int)items.size();
+			notempty.notify_one();
+			return stall;
+		}
+
+		bool pop (Item *&item, double &wait) {
+			std::unique_lock<std::mutex> guard (lock);
+			wait = 0.0;
+			if (items.empty() && producers>0) {
+				RFWTimer timer(true);
+				while (items.empty() && producers>0) notempty.wait (guard);
+				wait = timer.getTime();
+			}
+			if (items.empty()) return false;
+			item = items.front();
+			items.pop_front();
+			notfull.notify_one();
+			return true;
+		}
+
+		void producerDone() {
+			std::unique_lock<std::mutex> guard (lock);
+			if (--producers==0) notempty.notify_all();
+		}
+
+		int getPeak() const {return peak;}
+};
+
+
+static std::mutex statslock; //protects the totals of the stages
+static std::mutex windowlock; //protects nextfile and nextwritten
+static std::condition_variable windowmoved;
+
+
+SeriesPipeline::SeriesPipeline (int _depth, int _nreaders, int _ncomputers) {
+	depth = (_depth<1) ? 1 : _depth;
+	nreaders = (_nreaders<1) ? 1 : _nreaders;
+	ncomputers = (_ncomputers<1) ? 1 : _ncomputers;
+	team = 1;
+	names = NULL;
+	nfiles = nextfile = nextwritten = 0;
+	parsed = computed = NULL;
+	inflight = peakbytes = 0;
+	ngraphs = nignored = 0;
+	nvertices = narcs = 0;
+	treadbusy = treadstall = 0.0;
+	tcomputebusy = tcomputewait = tcomputestall = 0.0;
+	twritebusy = twritewait = 0.0;
+	ttotal = 0.0;
+	peakqueue = 0;
+	writeok = true;
+}
+
+void SeriesPipeline::addBytes (long long bytes) {
+	long long now = __sync_add_and_fetch (&inflight, bytes);
+	long long peak = peakbytes;
+	while (now>peak && !__sync_bool_compare_and_swap (&peakbytes, peak, now)) peak = peakbytes;
+}
+
+
+/*---------
+ | stages
+ *--------*/
+
+void SeriesPipeline::runReader (void *self) {((SeriesPipeline *)self)->reader();}
+void SeriesPipeline::runComputer (void *self) {((SeriesPipeline *)self)->computer();}
+void SeriesPipeline::runWriter (void *self) {((SeriesPipeline *)self)->writerLoop();}
+
+void SeriesPipeline::reader() {
+	double busy = 0.0, stall = 0.0;
+	int ignored = 0;
+	while (1) {
+		int f;
+		{
+			std::unique_lock<std::mutex> guard (windowlock);
+			if (nextfile<nfiles && nextfile>=nextwritten+depth) {
+				RFWTimer timer(true);
+				while (nextfile<nfiles && nextfile>=nextwritten+depth) windowmoved.wait (guard);
+				stall += timer.getTime();
+			}
+			f = nextfile;
+			if (f>=nfiles) break;
+			nextfile++;
+		}
+
+		RFWTimer timer(true);
+		Item *item = new Item;
+		item->index = f;
+		item->idom = NULL;
+		item->bytes = 0;
+		item->g = new DominatorGraph;
+		if (SeriesLoader::readGraph (names[f], reverse, simplify, compress, *item->g)) {
+			item->n = item->g->getNVertices();
+			item->root = item->g->getSource();
+			item->bytes = (long long)DominatorGraph::getStorageSize (item->n, item->g->getNArcs());
+			addBytes (item->bytes);
+		} else {
+			delete item->g; //no source: passed on only to keep the order
+			item->g = NULL;
+			ignored++;
+		}
+		busy += timer.getTime();
+		stall += parsed->push (item);
+	}
+	parsed->producerDone();
+
+	std::lock_guard<std::mutex> guard (statslock);
+	treadbusy += busy;
+	treadstall += stall;
+	nignored += ignored;
+}
+
+void SeriesPipeline::computer() {
+	double busy = 0.0, wait = 0.0, stall = 0.0;
+	int graphs = 0;
+	long long vertices = 0, arcs = 0;
+	Item *item;
+	double w;
+	DomThread::setTeam (team);
+	while (parsed->pop (item, w)) {
+		wait += w;
+		if (item->g) {
+			RFWTimer timer(true);
+			item->idom = mpNew<int> (item->n+1);
+			compute (item->g, item->idom, context);
+			graphs++;
+			vertices += item->n;
+			arcs += item->g->getNArcs();
+
+			//only the idoms go on
+			delete item->g;
+			item->g = NULL;
+			long long ibytes = (long long)(item->n+1) * sizeof(int);
+			addBytes (ibytes - item->bytes);
+			item->bytes = ibytes;
+			busy += timer.getTime();
+		}
+		stall += computed->push (item);
+	}
+	computed->producerDone();
+
+	std::lock_guard<std::mutex> guard (statslock);
+	tcomputebusy += busy;
+	tcomputewait += wait;
+	tcomputestall += stall;
+	ngraphs += graphs;
+	nvertices += vertices;
+	narcs += arcs;
+}
+
+void SeriesPipeline::writerLoop() {
+	std::vector<Item *> pending (nfiles, (Item *)NULL); //arrived out of order
+	int next = 0;
+	Item *item;
+	double w;
+	while (computed->pop (item, w)) {
+		twritewait += w;
+		pending[item->index] = item;
+		RFWTimer timer(true);
+		while (next<nfiles && pending[next]) {
+			Item *done = pending[next];
+			if (done->idom) {
+				if (idomfile) {
+					if (writer->getFormat()==IdomWriter::TEXT) fprintf (idomfile, "c %s\n", names[done->index]);
+					if (!writer->write (idomfile, done->n, done->idom, done->root)) writeok = false;
+				}
+				mpDelete (done->idom);
+				addBytes (-done->bytes);
+			}
+			delete done;
+			pending[next++] = NULL;
+		}
+		{
+			std::lock_guard<std::mutex> guard (windowlock);
+			nextwritten = next;
+		}
+		windowmoved.notify_all();
+		twritebusy += timer.getTime();
+	}
+}
+
+
+void SeriesPipeline::run (const char *listname, bool _reverse, bool _simplify, bool _compress,
+                          ComputeFunction _compute, void *_context, IdomWriter *_writer, FILE *_idomfile) {
+	RFWTimer timer(true);
+	reverse = _reverse;
+	simplify = _simplify;
+	compress = _compress;
+	compute = _compute;
+	context = _context;
+	writer = _writer;
+	idomfile = _idomfile;
+
+	names = SeriesLoader::readNames (listname, nfiles);
+	nextfile = nextwritten = 0;
+	parsed = new Queue (depth, nreaders);
+	computed = new Queue (depth, ncomputers);
+	team = DomThread::teamSize (ncomputers);
+
+	//one thread per reader and computer, plus the writer
+	int nthreads = nreaders + ncomputers + 1;
+	DomThread *threads = new DomThread [nthreads];
+	for (int i=0; i<nthreads; i++) {
+		threads[i].start ((i<nreaders) ? runReader : (i<nreaders+ncomputers) ? runComputer : runWriter, this);
+	}
+	for (int i=0; i<nthreads; i++) threads[i].join();
+	delete [] threads;
+
+	peakqueue = parsed->getPeak();
+	if (computed->getPeak()>peakqueue) peakqueue = computed->getPeak();
+	delete parsed;
+	delete computed;
+	parsed = computed = NULL;
+	SeriesLoader::freeNames (names, nfiles);
+	names = NULL;
+	ttotal = timer.getTime();
+}
+
+
+void SeriesPipeline::output (FILE *file) const {
+	fprintf (file, "pipelinedepth %d\n", depth);
+	fprintf (file, "pipelinereaders %d\n", nreaders);
+	fprintf (file, "pipelinecomputers %d\n", ncomputers);
+	fprintf (file, "graphs %d\n", ngraphs);
+	fprintf (file, "ignored %d\n", nignored);
+	fprintf (file, "totalv %lld\n", nvertices);
+	fprintf (file, "totala %lld\n", narcs);
+	fprintf (file, "pipelinetime %.6f\n", ttotal);
+	fprintf (file, "graphspersec %.4f\n", ttotal>0 ? (double)ngraphs/ttotal : 0.0);
+	fprintf (file, "pipelinestimeu %.8f\n", (nvertices+narcs) ? 1000000.0*ttotal/(double)(nvertices+narcs) : 0.0);
+	fprintf (file, "readbusy %.6f\n", treadbusy);
+	fprintf (file, "readstall %.6f\n", treadstall);
+	fprintf (file, "computebusy %.6f\n", tcomputebusy);
+	fprintf (file, "computewait %.6f\n", tcomputewait);
+	fprintf (file, "computestall %.6f\n", tcomputestall);
+	fprintf (file, "writebusy %.6f\n", twritebusy);
+	fprintf (file, "writewait %.6f\n", twritewait);
+	fprintf (file, "peakqueue %d\n", peakqueue);
+	fprintf (file, "peakbytes %lld\n", peakbytes);
+
+	//busy time per thread of each stage
+	double read = treadbusy / nreaders;
+	double comp = tcomputebusy / ncomputers;
+	const char *bottleneck = "read";
+	double worst = read;
+	if (comp>worst) {bottleneck = "compute"; worst = comp;}
+	if (twritebusy>worst) bottleneck = "write";
+	fprintf (file, "bottleneck %s\n", bottleneck);
+}
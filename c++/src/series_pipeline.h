@@ -0,0 +1,85 @@
+/**********************************************************
+ *
+ * SeriesPipeline
+ * - end-to-end run over a series without loading it first:
+ *   reader threads parse graphs into a bounded queue, 
+ *   compute threads run a method on them, and one writer 
+ *   thread streams the idoms out (in list order)
+ * - readers only claim a file within 'depth' positions of
+ *   the next one to be written, so at most 'depth' graphs
+ *   (read, computed, or waiting for their turn to be 
+ *   written) are in memory, whatever order they finish in
+ * - every stage reports its busy time and the time it was
+ *   stalled: readers blocked on a full queue or window, computers
+ *   waiting for input or blocked on output, the writer 
+ *   waiting for results; the stage with the largest busy
+ *   time per thread is reported as the bottleneck
+ *
+ **********************************************************/
+
+#ifndef series_pipeline_h
+#define series_pipeline_h
+
+#include "dgraph.h"
+#include "idom_writer.h"
+#include <stdio.h>
+
+class SeriesPipeline {
+	public:
+		//computes idom[1..n] of g from its source
+		typedef void (*ComputeFunction) (DominatorGraph *g, int *idom, void *context);
+
+	private:
+		struct Item;   //a graph on its way through the pipeline
+		class Queue;   //bounded queue of items
+
+		int depth, nreaders, ncomputers;
+		int team;         //OpenMP threads of each computer
+		bool reverse, simplify, compress;
+		ComputeFunction compute;
+		void *context;
+		IdomWriter *writer;
+		FILE *idomfile;
+
+		//shared state
+		char **names;
+		int nfiles;
+		int nextfile;     //next file to be claimed by a reader
+		int nextwritten;  //next file to be written (readers stay below nextwritten+depth)
+		Queue *parsed, *computed;
+		long long inflight, peakbytes; //bytes of graphs and idoms in the pipeline
+
+		//results (times are seconds, summed over the threads of a stage)
+		int ngraphs, nignored;
+		long long nvertices, narcs;
+		double treadbusy, treadstall;
+		double tcomputebusy, tcomputewait, tcomputestall;
+		double twritebusy, twritewait;
+		double ttotal;
+		int peakqueue;
+		bool writeok;
+
+		void addBytes (long long bytes);
+		void reader();
+		void computer();
+		void writerLoop();
+		static void runReader (void *self);
+		static void runComputer (void *self);
+		static void runWriter (void *self);
+
+	public:
+		SeriesPipeline (int _depth, int _nreaders, int _ncomputers);
+
+		//idomfile may be NULL (results are then discarded)
+		void run (const char *listname, bool _reverse, bool _simplify, bool _compress,
+		          ComputeFunction _compute, void *_context, IdomWriter *_writer, FILE *_idomfile);
+
+		int getNGraphs() const {return ngraphs;}
+		long long getNVertices() const {return nvertices;}
+		long long getNArcs() const {return narcs;}
+		double getTime() const {return ttotal;}
+		bool writeFailed() const {return !writeok;}
+		void output (FILE *file) const; //"name value" lines
+};
+
+#endif